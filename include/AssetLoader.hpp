@@ -0,0 +1,133 @@
+#pragma once
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Carga de recursos en segundo plano para que la ventana salga enseguida, se genere o no el mundo a la vez.
+// Los hilos de trabajo recorren las carpetas y decodifican imágenes (sf::Image), el sonido de daño
+// (sf::SoundBuffer) y la fuente; nada de eso toca OpenGL. Al terminar todo, el hilo principal recoge
+// los resultados con finished() y sube las imágenes al atlas él mismo (SpriteAtlas::build).
+// Mientras tanto el juego dibuja los rectángulos de color de siempre en lugar de los sprites.
+class AssetLoader {
+public:
+    AssetLoader(std::string imageDir, std::string musicDir, std::string fontPath, int threads = 1) {
+        jobs.push_back([this, imageDir, musicDir, fontPath]{ scan(imageDir, musicDir, fontPath); });
+        for (int i = 0; i < std::max(1, threads); ++i) workers.emplace_back(&AssetLoader::run, this);
+    }
+
+    ~AssetLoader() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            quit = true;
+        }
+        cv.notify_all();
+        for (auto &t : workers) t.join();
+    }
+
+    // Todo decodificado (o fallado); a partir de aquí los resultados ya no cambian
+    bool finished() const { return done.load(); }
+    // Progreso 0..1 para la pantalla de carga (0 mientras aún no se sabe cuántos hay)
+    float progress() const { int t = total.load(); return t > 0 ? (float)loaded.load() / t : 0.0f; }
+
+    // Resultados; solo leerlos con finished() == true
+    std::vector<std::pair<std::string, sf::Image>> images; // clave = nombre del archivo sin extensión
+    std::vector<std::string> musicFiles;
+    sf::SoundBuffer damageSound;
+    bool hasDamageSound = false;
+    sf::Font font;
+    bool hasFont = false;
+
+private:
+    static std::string lower(std::string s) {
+        std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c){ return (char)std::tolower(c); });
+        return s;
+    }
+
+    // Primer trabajo: listar las carpetas y encolar una decodificación por archivo
+    void scan(const std::string &imageDir, const std::string &musicDir, const std::string &fontPath) {
+        namespace fs = std::filesystem;
+        std::vector<std::function<void()>> found;
+        std::error_code ec;
+        if (fs::exists(imageDir, ec)) {
+            for (auto &ent : fs::directory_iterator(imageDir, ec)) {
+                if (!ent.is_regular_file()) continue;
+                std::string path = ent.path().string(), stem = ent.path().stem().string();
+                found.push_back([this, path, stem]{
+                    sf::Image img;
+                    if (!img.loadFromFile(path)) return;
+                    std::lock_guard<std::mutex> lk(m);
+                    images.push_back({stem, std::move(img)});
+                });
+            }
+        }
+        if (fs::exists(musicDir, ec)) {
+            for (auto &ent : fs::directory_iterator(musicDir, ec)) {
+                if (!ent.is_regular_file()) continue;
+                std::string ext = lower(ent.path().extension().string());
+                if (ext != ".ogg" && ext != ".wav" && ext != ".flac" && ext != ".mp3") continue;
+                std::string path = ent.path().string();
+                // el archivo llamado Danio (sin distinguir mayúsculas) es el sonido de daño; el resto, música
+                if (lower(ent.path().stem().string()) == "danio") {
+                    found.push_back([this, path]{
+                        sf::SoundBuffer buf;
+                        if (!buf.loadFromFile(path)) return;
+                        std::lock_guard<std::mutex> lk(m);
+                        damageSound = buf; hasDamageSound = true;
+                    });
+                } else {
+                    std::lock_guard<std::mutex> lk(m);
+                    musicFiles.push_back(path); // se abre en streaming al empezar: no hay nada que decodificar
+                }
+            }
+        }
+        found.push_back([this, fontPath]{
+            sf::Font f;
+            if (!f.loadFromFile(fontPath)) return;
+            std::lock_guard<std::mutex> lk(m);
+            font = f; hasFont = true;
+        });
+        total.store((int)found.size());
+        {
+            std::lock_guard<std::mutex> lk(m);
+            for (auto &j : found) jobs.push_back([this, j]{ j(); ++loaded; });
+        }
+        cv.notify_all();
+    }
+
+    void run() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [&]{ return quit || !jobs.empty() || busy == 0; });
+                if (quit || (jobs.empty() && busy == 0)) break;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+                ++busy;
+            }
+            job();
+            std::lock_guard<std::mutex> lk(m);
+            if (--busy == 0 && jobs.empty()) { done.store(true); cv.notify_all(); }
+        }
+    }
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> jobs;
+    int busy = 0;
+    bool quit = false;
+    std::atomic<int> total{0}, loaded{0};
+    std::atomic<bool> done{false};
+    std::vector<std::thread> workers;
+};
@@ -19,6 +19,11 @@ public:
     }
 
     ~Ball() {
+        // sacarlo del espacio antes de liberarlo: si no, el siguiente paso usaría memoria liberada
+        if (cpSpace *space = cpShapeGetSpace(shape)) {
+            cpSpaceRemoveShape(space, shape);
+            cpSpaceRemoveBody(space, body);
+        }
         cpShapeFree(shape);
         cpBodyFree(body);
     }
@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+
+// Identificador de bloque tal y como se guarda en los chunks (un byte por tile).
+// Los IDs son densos (0..BLOCK_COUNT-1) para indexar directamente la tabla BLOCKS.
+using BlockId = std::uint8_t;
+
+enum Block : BlockId { AIR = 0, GRASS, DIRT, STONE, WOOD, BEDR, LEAF, COAL, IRON, GOLD,
+    // New biomes blocks
+    SAND, SNOW, NETH, LAVA,
+    BLOCK_COUNT };
+
+// Herramientas; una herramienta acelera el picado de los bloques que la prefieren
+enum Tool : std::uint8_t { TOOL_NONE = 0, TOOL_PICKAXE, TOOL_AXE, TOOL_SHOVEL, TOOL_SWORD, TOOL_COUNT };
+static const char* const TOOL_KEYS[TOOL_COUNT] = { "", "pickaxe", "axe", "shovel", "sword" };   // texturas y partidas guardadas
+static const char* const TOOL_NAMES[TOOL_COUNT] = { "(none)", "Pico", "Hacha", "Pala", "Espada" }; // HUD
+
+// Propiedades de un tipo de bloque. Todo el juego las consulta aquí con un único acceso BLOCKS[id].
+struct BlockInfo {
+    const char *name;         // nombre para el HUD
+    std::uint8_t r, g, b;     // color del tile
+    float hardness;           // multiplicador del tiempo base de picado; < 0 = irrompible
+    Tool tool;                // herramienta que lo pica más rápido
+    bool solid;               // colisiona con jugador y enemigos
+    std::uint8_t light;       // luz que emite (0..15)
+    std::uint8_t opacity;     // niveles de luz que se pierden al atravesarlo (1 = transparente)
+    std::uint8_t flow;        // fluidos: ticks entre pasos de flujo (0 = no es un fluido)
+    bool falls;               // cae si debajo no hay nada sólido (arena)
+};
+
+constexpr BlockInfo BLOCKS[BLOCK_COUNT] = {
+    //  name        color           hardness  tool           solid  light opacity flow  falls
+    { "Aire",      135, 206, 235,   0.0f,    TOOL_NONE,     false,  0,  1,  0,    false },
+    { "Hierba",     88, 166,  72,   1.0f,    TOOL_NONE,     true,   0,  4,  0,    false },
+    { "Tierra",    134,  96,  67,   1.0f,    TOOL_SHOVEL,   true,   0,  4,  0,    false },
+    { "Piedra",    120, 120, 120,   2.0f,    TOOL_PICKAXE,  true,   0,  4,  0,    false },
+    { "Madera",    150, 111,  51,   0.8f,    TOOL_AXE,      true,   0,  4,  0,    false },
+    { "Roca madre", 40,  40,  40,  -1.0f,    TOOL_NONE,     true,   0,  4,  0,    false },
+    { "Hoja",      110, 180,  80,   0.4f,    TOOL_AXE,      true,   0,  2,  0,    false },
+    { "Carbón",     30,  30,  30,   1.2f,    TOOL_PICKAXE,  true,   0,  4,  0,    false },
+    { "Hierro",    180, 180, 200,   3.0f,    TOOL_PICKAXE,  true,   0,  4,  0,    false },
+    { "Oro",       212, 175,  55,   4.0f,    TOOL_PICKAXE,  true,   0,  4,  0,    false },
+    { "Arena",     194, 178, 128,   1.0f,    TOOL_SHOVEL,   true,   0,  4,  0,    true },
+    { "Nieve",     235, 245, 255,   1.0f,    TOOL_NONE,     true,   0,  4,  0,    false },
+    { "Neth",      120,  30,  30,   1.0f,    TOOL_NONE,     true,   0,  4,  0,    false },
+    { "Lava",      255, 120,  20,   1.0f,    TOOL_NONE,     false, 15,  1,  6,    false },
+};
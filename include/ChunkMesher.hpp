@@ -0,0 +1,201 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "JobSystem.hpp"
+#include "Lighting.hpp"
+#include "World.hpp"
+
+// Color de un bloque según la tabla BLOCKS
+inline sf::Color block_color(BlockId b) { const BlockInfo &i = BLOCKS[b]; return sf::Color(i.r, i.g, i.b); }
+
+// Color c con brillo k (0..1), conservando el alfa
+inline sf::Color shade_color(sf::Color c, float k) {
+    return sf::Color((sf::Uint8)std::min(255.0f, c.r * k), (sf::Uint8)std::min(255.0f, c.g * k), (sf::Uint8)std::min(255.0f, c.b * k), c.a);
+}
+
+// Construye y cachea un sf::VertexArray (quads) por chunk.
+// Un chunk solo se vuelve a mallar cuando set_block o un cambio de luz le marcan CHUNK_DIRTY_MESH; la
+// hora del día no cambia las mallas.
+// Las columnas que aún no se han cargado se dibujan como un bloque gris de relleno.
+// La luz de cada vértice es la media de la de los 4 tiles que lo comparten, con el cielo y los bloques
+// por separado en texCoords (x, y: 0..1). El color del vértice lleva ya el brillo a pleno día y un
+// shader lo escala al dibujar según 'daylight' (level_brightness); sin shaders se ve como a mediodía.
+// El aire solo se malla donde no le llega el cielo directo o tiene luz de bloques (cuevas, antorchas).
+// Con attachJobs, los chunks visibles que hay que remallar se construyen en paralelo (cada uno en su
+// propio VertexArray, que aún no toca OpenGL); dibujarlos sigue siendo cosa del hilo principal.
+class ChunkMesher {
+public:
+    explicit ChunkMesher(int tileSize) : tile(tileSize) {}
+
+    void attachJobs(JobSystem &js) { jobs = &js; }
+
+    // Dibuja los chunks que intersectan viewRect (coordenadas de mundo, en píxeles).
+    // daylight (0..1) escala la luz del cielo.
+    void draw(sf::RenderTarget &target, World &world, const sf::FloatRect &viewRect, float daylight) {
+        ++frame;
+        calls = 0;
+        float chunkPx = (float)(CHUNK_SIZE * tile);
+        int minCx = (int)std::floor(viewRect.left / chunkPx);
+        int minCy = (int)std::floor(viewRect.top / chunkPx);
+        int maxCx = (int)std::floor((viewRect.left + viewRect.width) / chunkPx);
+        int maxCy = (int)std::floor((viewRect.top + viewRect.height) / chunkPx);
+        placeholders.clear();
+        visible.clear();
+        rebuild.clear();
+        for (int cy = std::max(0, minCy); cy <= std::min(world.chunksY() - 1, maxCy); ++cy) {
+            for (int cx = minCx; cx <= maxCx; ++cx) {
+                if (!world.isColumnLoaded(cx)) { appendPlaceholder(cx, cy); continue; }
+                Chunk *c = world.chunkAt(cx, cy);
+                if (!c) continue; // chunk sin reservar: todo aire, se ve el fondo
+                Entry &e = meshes[key(cx, cy)]; // los punteros a valores de unordered_map no cambian al crecer
+                if (e.src != c || (c->dirty & CHUNK_DIRTY_MESH)) rebuild.push_back({&e, c});
+                e.lastFrame = frame;
+                visible.push_back(&e);
+            }
+        }
+        // remallar: cada trabajo escribe solo en su Entry y lee el mundo, que no cambia mientras tanto
+        parallel_for(jobs, 0, (int)rebuild.size(), 1, [&](int r0, int r1){
+            for (int r = r0; r < r1; ++r) build(world, *rebuild[r].chunk, rebuild[r].entry->vertices);
+        });
+        for (const Rebuild &r : rebuild) {
+            r.entry->src = r.chunk;
+            r.chunk->dirty &= (std::uint8_t)~CHUNK_DIRTY_MESH;
+        }
+        sf::RenderStates states;
+        if (loadShader()) {
+            shader.setUniform("daylight", daylight);
+            states.shader = &shader;
+        }
+        for (const Entry *e : visible) {
+            if (e->vertices.getVertexCount() == 0) continue;
+            target.draw(e->vertices, states);
+            ++calls;
+        }
+        if (placeholders.getVertexCount() > 0) { target.draw(placeholders); ++calls; }
+        // liberar mallas de chunks que llevan tiempo fuera de pantalla
+        if ((frame & 255) == 0) {
+            for (auto it = meshes.begin(); it != meshes.end();) {
+                if (frame - it->second.lastFrame > 256) it = meshes.erase(it); else ++it;
+            }
+        }
+    }
+
+    int drawCalls() const { return calls; }
+
+private:
+    struct Entry {
+        sf::VertexArray vertices{sf::Quads};
+        const Chunk *src = nullptr;
+        unsigned lastFrame = 0;
+    };
+
+    struct Rebuild {
+        Entry *entry;
+        Chunk *chunk;
+    };
+
+    static std::int64_t key(int cx, int cy) { return (std::int64_t)((std::uint64_t)(std::uint32_t)cx << 32 | (std::uint32_t)cy); }
+
+    // columna aún sin generar: un bloque gris liso hasta que llegue del hilo de generación
+    void appendPlaceholder(int cx, int cy) {
+        const sf::Color col(70, 70, 80);
+        float x0 = (float)(cx * CHUNK_SIZE * tile), y0 = (float)(cy * CHUNK_SIZE * tile);
+        float x1 = x0 + CHUNK_SIZE * tile, y1 = y0 + CHUNK_SIZE * tile;
+        placeholders.append(sf::Vertex(sf::Vector2f(x0, y0), col));
+        placeholders.append(sf::Vertex(sf::Vector2f(x1, y0), col));
+        placeholders.append(sf::Vertex(sf::Vector2f(x1, y1), col));
+        placeholders.append(sf::Vertex(sf::Vector2f(x0, y1), col));
+    }
+
+    // Shader que pasa el brillo a pleno día del color del vértice al de 'daylight' (se carga al primer
+    // draw, con el contexto de OpenGL ya creado)
+    bool loadShader() {
+        if (shaderState == 0) {
+            static const char *const src =
+                "uniform float daylight;\n"
+                "uniform float minBrightness;\n"
+                "void main() {\n"
+                "    vec2 l = gl_TexCoord[0].xy;\n"
+                "    float noon = minBrightness + (1.0 - minBrightness) * max(l.x, l.y);\n"
+                "    float now = minBrightness + (1.0 - minBrightness) * max(l.x * daylight, l.y);\n"
+                "    gl_FragColor = vec4(gl_Color.rgb * (now / noon), gl_Color.a);\n"
+                "}\n";
+            shaderState = (sf::Shader::isAvailable() && shader.loadFromMemory(src, sf::Shader::Fragment)) ? 1 : -1;
+            if (shaderState > 0) shader.setUniform("minBrightness", LIGHT_MIN_BRIGHTNESS);
+        }
+        return shaderState > 0;
+    }
+
+    // Vértice con el color c a pleno día y la luz (cielo, bloques) para el shader
+    static sf::Vertex litVertex(float x, float y, sf::Color c, sf::Vector2f light) {
+        return sf::Vertex(sf::Vector2f(x, y), shade_color(c, level_brightness(light.x, light.y, 1.0f)), light);
+    }
+
+    void build(const World &world, const Chunk &c, sf::VertexArray &va) const {
+        va.clear();
+        sf::Vector2f tileLight[CHUNK_SIZE + 2][CHUNK_SIZE + 2];
+        sf::Vector2f cornerLight[CHUNK_SIZE + 1][CHUNK_SIZE + 1];
+        int tx0 = c.cx * CHUNK_SIZE, ty0 = c.cy * CHUNK_SIZE;
+        // luz (cielo, bloques) de los tiles del chunk y de su borde (índice +1), y de cada esquina;
+        // fuera del mundo o sin cargar, cielo abierto
+        for (int y = 0; y < CHUNK_SIZE + 2; ++y)
+            for (int x = 0; x < CHUNK_SIZE + 2; ++x) {
+                const int tx = tx0 + x - 1, ty = ty0 + y - 1;
+                const std::uint8_t l = world.inBounds(tx, ty) ? world.light(tx, ty) : (std::uint8_t)(LIGHT_MAX << 4);
+                tileLight[y][x] = sf::Vector2f((float)sky_light(l) / LIGHT_MAX, (float)block_light(l) / LIGHT_MAX);
+            }
+        for (int y = 0; y <= CHUNK_SIZE; ++y)
+            for (int x = 0; x <= CHUNK_SIZE; ++x)
+                cornerLight[y][x] = 0.25f * (tileLight[y][x] + tileLight[y][x+1] + tileLight[y+1][x] + tileLight[y+1][x+1]);
+        float ox = (float)(tx0 * tile);
+        float oy = (float)(ty0 * tile);
+        for (int ly = 0; ly < CHUNK_SIZE; ++ly) {
+            for (int lx = 0; lx < CHUNK_SIZE; ++lx) {
+                BlockId b = c.get(lx, ly);
+                if (b == (BlockId)AIR) {
+                    // al aire con cielo directo y sin luz de bloques se le ve el fondo, que ya tiene ese color
+                    std::uint8_t l = world.light(tx0 + lx, ty0 + ly);
+                    if (sky_light(l) == LIGHT_MAX && block_light(l) == 0) continue;
+                }
+                const sf::Color col = block_color(b);
+                float x0 = ox + lx * tile, y0 = oy + ly * tile;
+                float x1 = x0 + tile, y1 = y0 + tile;
+                if (BLOCKS[b].flow > 0) {
+                    // fluido a medias: solo la parte llena, de abajo arriba (lo de encima se ve como aire)
+                    int level = world.fluidLevel(tx0 + lx, ty0 + ly);
+                    if (level < FLUID_MAX) {
+                        float top = y1 - (float)tile * level / FLUID_MAX;
+                        std::uint8_t l = world.light(tx0 + lx, ty0 + ly);
+                        if (!(sky_light(l) == LIGHT_MAX && block_light(l) == 0)) {
+                            const sf::Color air = block_color(AIR);
+                            va.append(litVertex(x0, y0, air, cornerLight[ly][lx]));
+                            va.append(litVertex(x1, y0, air, cornerLight[ly][lx+1]));
+                            va.append(litVertex(x1, top, air, cornerLight[ly][lx+1]));
+                            va.append(litVertex(x0, top, air, cornerLight[ly][lx]));
+                        }
+                        y0 = top;
+                    }
+                }
+                va.append(litVertex(x0, y0, col, cornerLight[ly][lx]));
+                va.append(litVertex(x1, y0, col, cornerLight[ly][lx+1]));
+                va.append(litVertex(x1, y1, col, cornerLight[ly+1][lx+1]));
+                va.append(litVertex(x0, y1, col, cornerLight[ly+1][lx]));
+            }
+        }
+    }
+
+    int tile;
+    sf::Shader shader;
+    int shaderState = 0; // 0 sin probar, 1 cargado, -1 no disponible
+    unsigned frame = 0;
+    int calls = 0;
+    std::unordered_map<std::int64_t, Entry> meshes;
+    sf::VertexArray placeholders{sf::Quads};
+    std::vector<Entry *> visible;
+    std::vector<Rebuild> rebuild;
+    JobSystem *jobs = nullptr;
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include "World.hpp"
+#include "WorldGen.hpp"
+
+// Carga y descarga columnas de chunks alrededor de la cámara.
+// La generación ocurre en varios hilos de trabajo (la salida es la misma con cualquier número de hilos,
+// ver WorldGen.hpp); el hilo principal solo encola peticiones e instala los resultados terminados,
+// nunca espera a que se genere nada.
+class ChunkStreamer {
+public:
+    ChunkStreamer(std::uint32_t seed, int height, int radius, int threads = 1)
+        : seed(seed), height(height), radius(radius), centers(1, 0) {
+        for (int i = 0; i < std::max(1, threads); ++i) workers.emplace_back(&ChunkStreamer::run, this);
+    }
+
+    ~ChunkStreamer() {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            quit = true;
+        }
+        cv.notify_all();
+        for (auto &t : workers) t.join();
+    }
+
+    // Columnas que necesita el anillo de World: radio de carga + margen de descarga a cada lado,
+    // por cada centro que se siga a la vez (el servidor sigue a cada jugador)
+    static int capacityFor(int radius, int centers = 1) { return (2 * (radius + 1) + 1) * centers; }
+
+    int loadRadius() const { return radius; }
+    std::size_t pendingCount() const { return pending.size(); }
+    int threadCount() const { return (int)workers.size(); }
+    const GenStats &stats() const { return genStats; }
+
+    // Avisos en el hilo principal: justo después de instalar una columna y justo antes de descargarla
+    std::function<void(World &, int)> onColumnLoaded;
+    std::function<void(World &, int)> onColumnUnload;
+
+    // Genera una columna en el hilo actual (solo para el arranque, alrededor del spawn)
+    void loadNow(World &world, int cx) {
+        if (world.isColumnLoaded(cx)) return;
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        generate_column(seed, height, cx, chunks, &genStats);
+        if (world.insertColumn(cx, chunks) && onColumnLoaded) onColumnLoaded(world, cx);
+    }
+
+    // Llamar una vez por frame desde el hilo principal con la columna de chunks de la cámara
+    void update(World &world, int centerCx) { update(world, &centerCx, 1); }
+
+    // Igual con varios centros: se mantiene cargada la unión de sus ventanas
+    void update(World &world, const int *centerCx, int count) {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            centers.assign(centerCx, centerCx + count);
+        }
+        // descargar lo que quedó fuera del radio (+1 de histéresis para no oscilar en el borde)
+        std::vector<int> far;
+        world.forEachColumn([&](int cx){ if (distance(cx, centerCx, count) > radius + 1) far.push_back(cx); });
+        for (int cx : far) {
+            if (onColumnUnload) onColumnUnload(world, cx);
+            world.unloadColumn(cx);
+        }
+
+        // instalar columnas terminadas
+        std::vector<Result> ready;
+        {
+            std::lock_guard<std::mutex> lk(m);
+            ready.swap(done);
+        }
+        for (auto &r : ready) {
+            pending.erase(r.cx);
+            if (!r.generated || distance(r.cx, centerCx, count) > radius + 1) continue;
+            if (!world.isColumnLoaded(r.cx) && world.insertColumn(r.cx, r.chunks) && onColumnLoaded) onColumnLoaded(world, r.cx);
+        }
+
+        // pedir las que faltan, de la más cercana a la más lejana; con centros a más de
+        // world.capacity() columnas unas de otras dos columnas comparten hueco del anillo
+        // y la segunda espera a que se descargue la primera
+        std::vector<int> want;
+        for (int d = 0; d <= radius; ++d) {
+            for (int i = 0; i < count; ++i) {
+                for (int cx : {centerCx[i] - d, centerCx[i] + d}) {
+                    if (!world.isColumnLoaded(cx) && world.isColumnSlotFree(cx) && !pending.count(cx)) { want.push_back(cx); pending.insert(cx); }
+                    if (d == 0) break;
+                }
+            }
+        }
+        if (!want.empty()) {
+            {
+                std::lock_guard<std::mutex> lk(m);
+                requests.insert(requests.end(), want.begin(), want.end());
+            }
+            if (want.size() > 1) cv.notify_all(); else cv.notify_one();
+        }
+    }
+
+private:
+    struct Result {
+        int cx;
+        bool generated;
+        std::vector<std::unique_ptr<Chunk>> chunks;
+    };
+
+    void run() {
+        for (;;) {
+            Result r;
+            {
+                std::unique_lock<std::mutex> lk(m);
+                cv.wait(lk, [&]{ return quit || !requests.empty(); });
+                if (quit) return;
+                r.cx = requests.front();
+                requests.pop_front();
+                // si la cámara ya se alejó, no gastar tiempo: se volverá a pedir si hace falta
+                r.generated = distance(r.cx, centers.data(), (int)centers.size()) <= radius + 1;
+            }
+            if (r.generated) generate_column(seed, height, r.cx, r.chunks, &genStats);
+            std::lock_guard<std::mutex> lk(m);
+            done.push_back(std::move(r));
+        }
+    }
+
+    // Distancia en columnas al centro más cercano
+    static int distance(int cx, const int *centerCx, int count) {
+        int best = INT_MAX;
+        for (int i = 0; i < count; ++i) best = std::min(best, std::abs(cx - centerCx[i]));
+        return best;
+    }
+
+    std::uint32_t seed;
+    int height;
+    int radius;
+    GenStats genStats;
+
+    std::unordered_set<int> pending; // solo hilo principal: pedidas y aún no instaladas
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<int> centers;
+    std::deque<int> requests;
+    std::vector<Result> done;
+    bool quit = false;
+
+    std::vector<std::thread> workers;
+};
@@ -0,0 +1,109 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "World.hpp"
+
+// Colisión de rectángulos (AABB) contra los tiles sólidos, común a jugador y enemigos.
+// Un cuerpo es cualquier tipo con w, h, vx, vy y posición x, y; los que la llaman de otra forma
+// (el jugador usa px, py) añaden una sobrecarga de body_x/body_y.
+// El movimiento es barrido: se comprueban todas las columnas/filas de tiles que cruza el borde
+// delantero, así que ni a 2000 px/s con un dt grande se atraviesa un suelo de un tile.
+// Por encima y por debajo del mundo no hay nada sólido; las columnas sin cargar son sólidas (como roca
+// madre en get_block), para que nadie caiga por una columna que aún no ha llegado. Un cuerpo que ya está
+// dentro de una (el servidor no tiene cargado todo) se queda quieto hasta que se cargue.
+
+// Contactos de un movimiento (máscara)
+enum Contact : std::uint8_t { CONTACT_NONE = 0, CONTACT_GROUND = 1, CONTACT_CEILING = 2, CONTACT_WALL_LEFT = 4, CONTACT_WALL_RIGHT = 8 };
+
+template <class B> float &body_x(B &b) { return b.x; }
+template <class B> float &body_y(B &b) { return b.y; }
+template <class B> float body_x(const B &b) { return b.x; }
+template <class B> float body_y(const B &b) { return b.y; }
+
+inline bool solid_tile(const World &w, int tx, int ty) {
+    if (ty < 0 || ty >= w.height()) return false;
+    return !w.isColumnLoaded(tx >> CHUNK_SHIFT) || BLOCKS[w.get(tx, ty)].solid;
+}
+
+inline int tile_of(float px) { return static_cast<int>(std::floor(px / TILE)); }
+
+// ¿Alguna de las columnas tx0..tx1 es sólida en la fila ty?
+inline bool solid_row(const World &w, int tx0, int tx1, int ty) {
+    for (int tx = tx0; tx <= tx1; ++tx) if (solid_tile(w, tx, ty)) return true;
+    return false;
+}
+
+// ¿Alguna de las filas ty0..ty1 es sólida en la columna tx?
+inline bool solid_column(const World &w, int tx, int ty0, int ty1) {
+    for (int ty = ty0; ty <= ty1; ++ty) if (solid_tile(w, tx, ty)) return true;
+    return false;
+}
+
+// Suelo sólido justo debajo del cuerpo
+template <class B>
+bool on_ground(const World &w, const B &b) {
+    float x = body_x(b), y = body_y(b);
+    return solid_row(w, tile_of(x), tile_of(x + b.w - 1), tile_of(y + b.h + 1));
+}
+
+// ¿Toca el cuerpo algún tile del bloque b? (p. ej. lava)
+template <class B>
+bool touches_block(const World &w, const B &b, BlockId block) {
+    float x = body_x(b), y = body_y(b);
+    for (int ty = tile_of(y), ty1 = tile_of(y + b.h - 1); ty <= ty1; ++ty)
+        for (int tx = tile_of(x), tx1 = tile_of(x + b.w - 1); tx <= tx1; ++tx)
+            if (w.inBounds(tx, ty) && w.get(tx, ty) == block) return true;
+    return false;
+}
+
+// Mueve el cuerpo vx*dt en horizontal y luego vy*dt en vertical, parando en el primer tile sólido
+// de cada eje (y poniendo a 0 esa velocidad). Devuelve los contactos.
+template <class B>
+std::uint8_t move_body(const World &w, B &b, float dt) {
+    std::uint8_t contacts = CONTACT_NONE;
+    float &x = body_x(b);
+    float &y = body_y(b);
+    if (!w.isColumnLoaded(tile_of(x) >> CHUNK_SHIFT) || !w.isColumnLoaded(tile_of(x + b.w - 1) >> CHUNK_SHIFT)) {
+        b.vx = b.vy = 0; // dentro de una columna sin cargar: esperar a que llegue
+        return contacts;
+    }
+
+    // horizontal: columnas desde la que ocupa el borde delantero hasta la de destino
+    float newX = x + b.vx * dt;
+    int top = tile_of(y), bottom = tile_of(y + b.h - 1);
+    if (b.vx > 0) {
+        for (int tx = tile_of(x + b.w - 1), end = tile_of(newX + b.w - 1); tx <= end; ++tx) {
+            if (solid_column(w, tx, top, bottom)) { newX = tx * TILE - b.w; b.vx = 0; contacts |= CONTACT_WALL_RIGHT; break; }
+        }
+    } else if (b.vx < 0) {
+        for (int tx = tile_of(x), end = tile_of(newX); tx >= end; --tx) {
+            if (solid_column(w, tx, top, bottom)) { newX = (float)(tx + 1) * TILE; b.vx = 0; contacts |= CONTACT_WALL_LEFT; break; }
+        }
+    }
+    x = newX;
+
+    // vertical, con la x ya movida
+    float newY = y + b.vy * dt;
+    int left = tile_of(x), right = tile_of(x + b.w - 1);
+    if (b.vy > 0) { // cayendo
+        for (int ty = tile_of(y + b.h - 1), end = tile_of(newY + b.h - 1); ty <= end; ++ty) {
+            if (solid_row(w, left, right, ty)) { newY = ty * TILE - b.h; b.vy = 0; contacts |= CONTACT_GROUND; break; }
+        }
+    } else if (b.vy < 0) { // subiendo
+        for (int ty = tile_of(y), end = tile_of(newY); ty >= end; --ty) {
+            if (solid_row(w, left, right, ty)) { newY = (float)(ty + 1) * TILE; b.vy = 0; contacts |= CONTACT_CEILING; break; }
+        }
+    }
+    y = newY;
+    return contacts;
+}
+
+// Mueve en lote los cuerpos bodies[ids[i]]; si contacts no es nulo, guarda ahí los de cada uno
+template <class B>
+void move_bodies(const World &w, B *bodies, const int *ids, std::size_t count, float dt, std::uint8_t *contacts = nullptr) {
+    for (std::size_t i = 0; i < count; ++i) {
+        std::uint8_t c = move_body(w, bodies[ids[i]], dt);
+        if (contacts) contacts[i] = c;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "World.hpp"
+
+// Bloques con gravedad (BLOCKS[b].falls, hoy la arena): si debajo queda aire, bajan un tile por tick.
+// Es una cola de tiles por revisar, alimentada por World::fallEdits (quitar un apoyo, poner arena en el aire)
+// y por los propios movimientos. Se recorre de abajo arriba, así que una columna entera baja a la vez.
+// Cada tick mueve como mucho 'budget' bloques; lo que no cabe espera al siguiente, de modo que picar la
+// base de una columna de 40 tiles reparte el trabajo en vez de hacerlo todo en un frame.
+class FallingBlocks {
+public:
+    explicit FallingBlocks(std::size_t budget) : budget(budget) {}
+
+    // Avanza un tick; devuelve cuántos bloques bajaron
+    std::size_t step(World &w) {
+        for (auto &e : w.fallEdits) { next.push_back({e.first, e.second}); next.push_back({e.first, e.second - 1}); }
+        w.fallEdits.clear();
+        current.swap(next);
+        next.clear();
+        std::sort(current.begin(), current.end(), [](const Cell &a, const Cell &b){ return a.y != b.y ? a.y > b.y : a.x < b.x; });
+        current.erase(std::unique(current.begin(), current.end(), [](const Cell &a, const Cell &b){ return a.x == b.x && a.y == b.y; }), current.end());
+        moved = 0;
+        for (const Cell &c : current) {
+            if (!w.inBounds(c.x, c.y) || !w.inBounds(c.x, c.y + 1)) continue;
+            BlockId b = w.get(c.x, c.y);
+            if (!BLOCKS[b].falls || w.get(c.x, c.y + 1) != (BlockId)AIR) continue;
+            if (moved == budget) { next.push_back(c); continue; } // sin presupuesto: al siguiente tick
+            // los dos set() apuntan el tile de destino y el hueco en fallEdits, que los despiertan
+            w.set(c.x, c.y + 1, b);
+            w.set(c.x, c.y, AIR);
+            ++moved;
+        }
+        total += moved;
+        return moved;
+    }
+
+    std::size_t lastMoved() const { return moved; }
+    std::size_t pending() const { return next.size(); }
+    std::uint64_t totalMoved() const { return total; }
+
+private:
+    struct Cell { int x, y; };
+
+    std::size_t budget;
+    std::size_t moved = 0;
+    std::uint64_t total = 0;
+    std::vector<Cell> current, next;
+};
@@ -0,0 +1,155 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include "World.hpp"
+
+// Campo de flujo (mapa de Dijkstra) hacia un tile objetivo, normalmente donde está el jugador.
+// Cubre una ventana cuadrada de (2*radius+1)^2 tiles centrada en el objetivo. Los nodos son los tiles
+// "de pie": no sólidos y con suelo sólido debajo. Desde un nodo se puede:
+//  - andar al nodo de al lado
+//  - saltar a un nodo de la columna de al lado hasta jumpTiles más arriba (con hueco encima)
+//  - dejarse caer por la columna de al lado hasta el primer suelo
+// Cada nodo guarda la distancia al objetivo y el primer movimiento del camino más corto, así que
+// cualquier número de enemigos lo consulta en O(1) con sample().
+// Solo se recalcula cuando el objetivo cambia de tile o cambia algún tile sólido de la ventana (se guarda
+// una copia para distinguirlo de los cambios de World::solidRevision de fuera), y como mucho una vez
+// cada minTicks ticks: la arena que cae cambia la solidez cada tick y mientras tanto basta el campo anterior.
+class FlowField {
+public:
+    static constexpr std::uint16_t UNREACHABLE = 0xFFFF;
+
+    // Primer movimiento desde un nodo: dir -1/0/+1 en x; jump = hay que saltar
+    struct Step {
+        bool valid;          // el tile es un nodo alcanzable de la ventana
+        int dir;
+        bool jump;
+        std::uint16_t dist;  // coste hasta el objetivo
+    };
+
+    FlowField(int radius, int jumpTiles, int minTicks) : radius(radius), jumpTiles(jumpTiles), minTicks(minTicks), size(2 * radius + 1) {
+        dist.assign((std::size_t)size * size, UNREACHABLE);
+        move.assign((std::size_t)size * size, 0);
+        solid.assign((std::size_t)size * (size + 1), 0);
+    }
+
+    // Rehace el campo si el objetivo o la ventana cambiaron; devuelve true si lo rehizo. tick es el
+    // tick de la simulación (el resultado no depende del tiempo real).
+    bool update(const World &w, int goalX, int goalY, std::uint64_t tick) {
+        const bool moved = !built || goalX != gx || goalY != gy;
+        if (!moved && w.solidRevision == revision) return false;
+        if (built && tick < nextTick) return false;
+        nextTick = tick + minTicks;
+        revision = w.solidRevision;
+        gx = goalX; gy = goalY;
+        if (!readSolid(w) && !moved) return false; // los cambios fueron fuera de la ventana
+        built = true;
+        rebuild();
+        ++rebuilds;
+        return true;
+    }
+
+    Step sample(int tx, int ty) const {
+        int i = index(tx, ty);
+        if (i < 0 || dist[i] == UNREACHABLE) return Step{false, 0, false, UNREACHABLE};
+        std::int8_t m = move[i];
+        return Step{true, (m & 3) == 1 ? -1 : (m & 3) == 2 ? 1 : 0, (m & JUMP_BIT) != 0, dist[i]};
+    }
+
+    int goalX() const { return gx; }
+    int goalY() const { return gy; }
+    std::uint64_t rebuildCount() const { return rebuilds; }
+
+    // Tile "de pie": libre y con suelo sólido debajo. Fuera del mundo cuenta como sólido.
+    static bool standable(const World &w, int x, int y) { return !solidAt(w, x, y) && solidAt(w, x, y + 1); }
+
+private:
+    static constexpr std::int8_t JUMP_BIT = 4;
+    using Item = std::pair<int, int>; // (distancia, índice)
+    using OpenList = std::priority_queue<Item, std::vector<Item>, std::greater<Item>>;
+
+    static bool solidAt(const World &w, int x, int y) { return !w.inBounds(x, y) || BLOCKS[w.get(x, y)].solid; }
+
+    // Copia la solidez de la ventana más la fila de debajo (la del suelo de la última fila de nodos);
+    // true si algo cambió respecto a la copia anterior
+    bool readSolid(const World &w) {
+        bool changed = false;
+        for (int ly = 0; ly <= size; ++ly) {
+            for (int lx = 0; lx < size; ++lx) {
+                std::uint8_t v = solidAt(w, gx - radius + lx, gy - radius + ly) ? 1 : 0;
+                std::uint8_t &cell = solid[(std::size_t)ly * size + lx];
+                changed |= cell != v;
+                cell = v;
+            }
+        }
+        return changed;
+    }
+
+    // Lo mismo que solidAt/standable pero sobre la copia; fuera de ella cuenta como sólido
+    // (solo lo consultan movimientos desde tiles de fuera, que relax() descarta)
+    bool solidIn(int x, int y) const {
+        int lx = x - (gx - radius), ly = y - (gy - radius);
+        if (lx < 0 || ly < 0 || lx >= size || ly > size) return true;
+        return solid[(std::size_t)ly * size + lx] != 0;
+    }
+    bool standableIn(int x, int y) const { return !solidIn(x, y) && solidIn(x, y + 1); }
+
+    int index(int tx, int ty) const {
+        int lx = tx - (gx - radius), ly = ty - (gy - radius);
+        if (lx < 0 || ly < 0 || lx >= size || ly >= size) return -1;
+        return ly * size + lx;
+    }
+
+    // Dijkstra hacia atrás desde el objetivo: para cada nodo v ya cerrado, se buscan los nodos u
+    // que pueden llegar a v con un movimiento y se les apunta ese movimiento como primer paso.
+    void rebuild() {
+        std::fill(dist.begin(), dist.end(), UNREACHABLE);
+        std::fill(move.begin(), move.end(), 0);
+        int g = index(gx, gy);
+        if (!standableIn(gx, gy)) return;
+        OpenList open;
+        dist[g] = 0;
+        open.push({0, g});
+        while (!open.empty()) {
+            Item top = open.top(); open.pop();
+            if (top.first != dist[top.second]) continue;
+            int vx = (gx - radius) + top.second % size, vy = (gy - radius) + top.second / size;
+            for (int side = -1; side <= 1; side += 2) {
+                int ux = vx + side; // u se mueve hacia -side para llegar a v
+                std::int8_t toV = side > 0 ? 1 : 2; // dir -1 o +1 codificada
+                // andar
+                if (standableIn(ux, vy)) relax(open, ux, vy, top.first + 2, toV);
+                // saltar desde abajo: u está k tiles más abajo y tiene hueco encima para subir
+                for (int k = 1; k <= jumpTiles; ++k) {
+                    if (solidIn(ux, vy - 1 + k)) break; // la columna de u está tapada a esa altura
+                    if (standableIn(ux, vy + k)) { relax(open, ux, vy + k, top.first + 2 + 2 * k, (std::int8_t)(toV | JUMP_BIT)); break; }
+                }
+                // caer desde arriba: u está en la columna de al lado más arriba y la de v está libre hasta v
+                for (int y = vy - 1; y >= gy - radius && !solidIn(vx, y); --y) {
+                    if (standableIn(ux, y)) relax(open, ux, y, top.first + 2 + (vy - y), toV);
+                }
+            }
+        }
+    }
+
+    void relax(OpenList &open, int x, int y, int d, std::int8_t m) {
+        int i = index(x, y);
+        if (i < 0 || d >= dist[i] || d >= UNREACHABLE) return;
+        dist[i] = (std::uint16_t)d;
+        move[i] = m;
+        open.push({d, i});
+    }
+
+    int radius, jumpTiles, minTicks, size;
+    int gx = 0, gy = 0;
+    std::uint32_t revision = 0;
+    bool built = false;
+    std::uint64_t nextTick = 0;
+    std::uint64_t rebuilds = 0;
+    std::vector<std::uint16_t> dist;
+    std::vector<std::int8_t> move;
+    std::vector<std::uint8_t> solid; // (size+1) filas de size tiles, 1 = sólido
+};
@@ -0,0 +1,97 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "World.hpp"
+
+// Autómata celular para los fluidos (bloques con BLOCKS[b].flow > 0, hoy la lava).
+// Cada tile de fluido tiene un nivel 1..FLUID_MAX (World::fluidLevel) que se conserva al fluir:
+// primero cae todo lo que cabe en el tile de abajo y luego, si le queda más de 1, cede una unidad
+// a cada lado más bajo en al menos 2. Un hilo de nivel 1 ya no se extiende, así que todo acaba quieto.
+//
+// Solo se visitan las celdas activas: las que cambiaron en el paso anterior, sus vecinas y las que
+// rodean un cambio de bloque (World::fluidEdits, p. ej. picar la pared de una bolsa de lava).
+// Cuando nada se mueve la lista queda vacía y el coste es cero, sea cual sea el tamaño del mundo.
+class FluidSim {
+public:
+    // Avanza un tick; devuelve cuántas celdas de fluido se procesaron
+    std::size_t step(World &w) {
+        ++tick;
+        for (auto &e : w.fluidEdits) wake(e.first, e.second);
+        w.fluidEdits.clear();
+        current.swap(next);
+        next.clear();
+        // de abajo arriba, y sin repetidas
+        std::sort(current.begin(), current.end(), [](const Cell &a, const Cell &b){ return a.y != b.y ? a.y > b.y : a.x < b.x; });
+        current.erase(std::unique(current.begin(), current.end(), [](const Cell &a, const Cell &b){ return a.x == b.x && a.y == b.y; }), current.end());
+        std::size_t processed = 0;
+        for (const Cell &c : current) {
+            if (!w.inBounds(c.x, c.y)) continue;
+            BlockId b = w.get(c.x, c.y);
+            int flow = BLOCKS[b].flow;
+            if (flow == 0) continue;
+            if (tick % (unsigned)flow != 0) { next.push_back(c); continue; } // fluido lento: espera su turno
+            ++processed;
+            flowCell(w, c.x, c.y, b);
+        }
+        return processed;
+    }
+
+    std::size_t activeCount() const { return next.size(); }
+
+private:
+    struct Cell { int x, y; };
+
+    // la celda y sus cuatro vecinas pasan al siguiente paso
+    void wake(int x, int y) {
+        next.push_back({x, y});
+        next.push_back({x - 1, y}); next.push_back({x + 1, y});
+        next.push_back({x, y - 1}); next.push_back({x, y + 1});
+    }
+
+    // ¿Puede entrar fluido b en (x, y)? (aire o el mismo fluido); devuelve el nivel que ya tiene en 'level'
+    static bool accepts(const World &w, int x, int y, BlockId b, int &level) {
+        if (!w.inBounds(x, y)) return false;
+        BlockId t = w.get(x, y);
+        if (t == (BlockId)AIR) { level = 0; return true; }
+        if (t != b) return false;
+        level = w.fluidLevel(x, y);
+        return true;
+    }
+
+    // Pone el nivel de (x, y); 0 lo convierte en aire
+    void setLevel(World &w, int x, int y, BlockId b, int level) {
+        if (level <= 0) w.set(x, y, AIR);
+        else {
+            if (w.get(x, y) != b) w.set(x, y, b);
+            w.setFluidLevel(x, y, level);
+        }
+        wake(x, y);
+    }
+
+    void flowCell(World &w, int x, int y, BlockId b) {
+        int level = w.fluidLevel(x, y);
+        int below;
+        if (accepts(w, x, y + 1, b, below) && below < FLUID_MAX) {
+            int moved = std::min(level, FLUID_MAX - below);
+            setLevel(w, x, y + 1, b, below + moved);
+            level -= moved;
+            setLevel(w, x, y, b, level);
+            if (level == 0) return;
+        }
+        if (level <= 1) return;
+        int start = level;
+        for (int dx : {-1, 1}) {
+            int side;
+            if (level > 1 && accepts(w, x + dx, y, b, side) && side < level - 1) {
+                setLevel(w, x + dx, y, b, side + 1);
+                --level;
+            }
+        }
+        if (level != start) setLevel(w, x, y, b, level);
+    }
+
+    std::vector<Cell> current, next;
+    unsigned tick = 0;
+};
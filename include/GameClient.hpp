@@ -0,0 +1,252 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Net.hpp"
+#include "Simulation.hpp"
+
+// Cliente de GameServer (--connect). No simula: el mundo se rellena con las columnas y las diferencias
+// que manda el servidor (World::set, así que la luz y las mallas se actualizan como en local) y el
+// jugador, su HUD y los enemigos salen de la última snapshot (apply). Cada tick manda su SimInput.
+class GameClient {
+public:
+    // Conecta, saluda y espera la bienvenida como mucho 'timeout'
+    bool connect(const sf::IpAddress &host, unsigned short port, sf::Time timeout = sf::seconds(5.0f)) {
+        if (tcp.connect(host, port, timeout) != sf::Socket::Done) return false;
+        if (udp.bind(sf::Socket::AnyPort) != sf::Socket::Done) return false;
+        udp.setBlocking(false);
+        server = host;
+        serverPort = port;
+
+        BinWriter hello;
+        hello.put((std::uint8_t)MSG_HELLO); hello.put(NET_PROTOCOL); hello.put((std::uint16_t)udp.getLocalPort());
+        sf::Packet out;
+        out.append(hello.data().data(), hello.data().size());
+        if (tcp.send(out) != sf::Socket::Done) return false;
+        stats.sent(MSG_HELLO, hello.data().size());
+
+        sf::SocketSelector selector;
+        selector.add(tcp);
+        sf::Packet in;
+        if (!selector.wait(timeout) || tcp.receive(in) != sf::Socket::Done) return false;
+        BinReader r((const char *)in.getData(), in.getDataSize());
+        std::uint8_t type = NET_MSG_COUNT;
+        std::int32_t height = 0, radius = 0, rate = 0;
+        if (!r.get(type) || type != MSG_WELCOME || !r.get(myId) || !r.get(token) || !r.get(height) || !r.get(radius) || !r.get(rate)) return false;
+        stats.received(MSG_WELCOME, in.getDataSize());
+        worldHeight = height; viewRadius = radius; netRate = std::max(1, rate);
+        tcp.setBlocking(false);
+        online = true;
+        return true;
+    }
+
+    bool connected() const { return online; }
+    std::uint8_t id() const { return myId; }
+    int height() const { return worldHeight; }
+    // columnas que manda el servidor a cada lado de la del jugador (para dimensionar World)
+    int radius() const { return viewRadius; }
+
+    // La entrada de este tick, con la última snapshot recibida como confirmación
+    void sendInput(const SimInput &in) {
+        if (!online) return;
+        BinWriter w;
+        w.put((std::uint8_t)MSG_INPUT); w.put(myId); w.put(token); w.put(++inputSeq); w.put(lastTick);
+        InputLog::writeInput(w, in);
+        if (udp.send(w.data().data(), w.data().size(), server, serverPort) == sf::Socket::Done) stats.sent(MSG_INPUT, w.data().size());
+    }
+
+    // Lee lo que haya llegado: columnas y diferencias van directas a world, las snapshots se guardan para apply()
+    void poll(World &world) {
+        while (online) {
+            sf::Packet packet;
+            sf::Socket::Status st = tcp.receive(packet);
+            if (st == sf::Socket::NotReady || st == sf::Socket::Partial) break;
+            if (st != sf::Socket::Done) { online = false; break; }
+            stats.received(packet.getDataSize() > 0 ? *(const std::uint8_t *)packet.getData() : NET_MSG_COUNT, packet.getDataSize());
+            BinReader r((const char *)packet.getData(), packet.getDataSize());
+            std::uint8_t type = NET_MSG_COUNT;
+            r.get(type);
+            if (type == MSG_COLUMN) readColumn(world, r);
+            else if (type == MSG_CHUNK_DELTA) readDelta(world, r);
+            else if (type == MSG_COLUMN_DROP) { std::int32_t cx = 0; if (r.get(cx)) world.unloadColumn(cx); }
+        }
+        // los fluidos y la arena los simula el servidor: aquí solo llegan sus resultados
+        world.fluidEdits.clear();
+        world.fallEdits.clear();
+
+        datagram.resize(sf::UdpSocket::MaxDatagramSize);
+        for (;;) {
+            std::size_t n = 0;
+            sf::IpAddress from;
+            unsigned short port = 0;
+            if (udp.receive(datagram.data(), datagram.size(), n, from, port) != sf::Socket::Done) break;
+            if (from != server || port != serverPort) continue;
+            BinReader r(datagram.data(), n);
+            std::uint8_t type = NET_MSG_COUNT;
+            r.get(type);
+            stats.received(type, n);
+            if (type == MSG_SNAPSHOT) readSnapshot(r);
+        }
+    }
+
+    // Copia la última snapshot en sim (jugador propio, vida, inventario, enemigos, objetos) para dibujarla como
+    // en local. Devuelve false si no ha llegado ninguna nueva desde la llamada anterior.
+    bool apply(Simulation &sim) {
+        if (!fresh) return false;
+        fresh = false;
+        sim.prevPx = sim.p.px; sim.prevPy = sim.p.py;
+        for (const NetEntity &e : entities) {
+            if (e.id != myId) continue;
+            sim.p.px = e.px(); sim.p.py = e.py();
+            sim.p.fx = (e.flags & NET_FACING_LEFT) ? -1 : 1;
+        }
+        sim.playerHealth = self.health;
+        sim.playerInvuln = (self.flags & NET_INVULN) ? 1.0f : 0.0f;
+        sim.swingActive = (self.flags & NET_SWING) ? 1.0f : 0.0f;
+        sim.breaking = (self.flags & NET_BREAKING) != 0;
+        sim.breakX = self.breakX; sim.breakY = self.breakY; sim.breakProgress = self.breakProgress;
+        sim.p.selected = self.selected < BLOCK_COUNT ? (BlockId)self.selected : sim.p.selected;
+        sim.p.selectedTool = self.tool < TOOL_COUNT ? (Tool)self.tool : TOOL_NONE;
+        for (int i = 0; i < HOTBAR_SIZE; ++i) sim.p.inv[HOTBAR[i]] = self.counts[i];
+        sim.dayTime = dayTime;
+        sim.weatherMode = weather;
+
+        // enemigos: los de la snapshot; la posición anterior, la de la snapshot previa si estaban
+        sim.enemies.clear();
+        sim.enemyPrev.clear();
+        for (const NetEntity &e : entities) {
+            if (e.id < NET_ENEMY_ID || e.id >= NET_ITEM_ID || e.kind == 0) continue;
+            Enemy en{};
+            en.type = (Enemy::Type)(e.kind - 1);
+            en.x = e.px(); en.y = e.py();
+            en.w = sim.p.w; en.h = sim.p.h;
+            en.vx = (e.flags & NET_FACING_LEFT) ? -1.0f : 1.0f;
+            en.fuseTimer = (e.flags & NET_FUSE) ? 1.0f : 0.0f;
+            en.alive = (e.flags & NET_ALIVE) != 0;
+            en.hp = e.hp;
+            const NetEntity *before = find(prevEntities, e.id);
+            sim.enemies.push_back(en);
+            sim.enemyPrev.push_back(before ? sf::Vector2f(before->px(), before->py()) : sf::Vector2f(en.x, en.y));
+        }
+
+        // objetos soltados: igual, dormidos (aquí no se simulan)
+        sim.items.clear();
+        for (const NetEntity &e : entities) {
+            if (e.kind != NET_KIND_ITEM || e.hp >= BLOCK_COUNT) continue;
+            const NetEntity *before = find(prevEntities, e.id);
+            sim.items.put(e.px(), e.py(), before ? before->px() : e.px(), before ? before->py() : e.py(), (BlockId)e.hp, e.flags);
+        }
+        return true;
+    }
+
+    // Fracción (0..1) del intervalo entre snapshots transcurrida desde la última: interpolar con ella
+    // entre la snapshot anterior y la última (playerDrawPos, enemyDrawPos, otherPlayers)
+    float lerp() const { return std::min(1.0f, sinceSnapshot.getElapsedTime().asSeconds() * netRate); }
+
+    // Posición interpolada de los demás jugadores cercanos
+    void otherPlayers(float alpha, std::vector<sf::Vector2f> &out) const {
+        out.clear();
+        for (const NetEntity &e : entities) {
+            if (e.id >= NET_ENEMY_ID || e.id == myId) continue;
+            const NetEntity *before = find(prevEntities, e.id);
+            sf::Vector2f cur(e.px(), e.py()), prev = before ? sf::Vector2f(before->px(), before->py()) : cur;
+            out.push_back(prev + (cur - prev) * alpha);
+        }
+    }
+
+    NetStats stats;
+    std::uint32_t snapshots = 0, snapshotsSkipped = 0; // recibidas y descartadas (atrasadas o sin base)
+
+private:
+    struct Snapshot {
+        std::uint32_t tick = 0;
+        std::vector<NetEntity> entities;
+        NetSelf self;
+    };
+
+    static const NetEntity *find(const std::vector<NetEntity> &v, std::uint16_t id) {
+        auto it = std::lower_bound(v.begin(), v.end(), id, [](const NetEntity &e, std::uint16_t x){ return e.id < x; });
+        return (it != v.end() && it->id == id) ? &*it : nullptr;
+    }
+
+    // COLUMN: cx, número de chunks y cada chunk en RLE (vacío = todo aire)
+    void readColumn(World &world, BinReader &r) {
+        std::int32_t cx = 0;
+        std::uint16_t n = 0;
+        if (!r.get(cx) || !r.get(n)) return;
+        std::vector<std::unique_ptr<Chunk>> chunks(world.chunksY());
+        std::string rle;
+        for (int cy = 0; cy < n; ++cy) {
+            if (!r.getString(rle)) return;
+            if (rle.empty() || cy >= world.chunksY()) continue;
+            chunks[cy].reset(new Chunk(cx, cy, (BlockId)AIR));
+            if (!RegionStore::decode((const unsigned char *)rle.data(), rle.size(), *chunks[cy])) return;
+        }
+        world.unloadColumn(cx);
+        // el hueco del anillo puede seguir ocupado si el DROP de la columna vieja aún no ha llegado
+        if (!world.insertColumn(cx, chunks)) return;
+    }
+
+    // CHUNK_DELTA: cx, cy y los tiles cambiados (encode_chunk_delta)
+    void readDelta(World &world, BinReader &r) {
+        std::int32_t cx = 0, cy = 0;
+        std::string delta;
+        if (!r.get(cx) || !r.get(cy) || !r.getString(delta) || !world.isColumnLoaded(cx)) return;
+        const int x0 = cx * CHUNK_SIZE, y0 = cy * CHUNK_SIZE;
+        decode_chunk_delta((const unsigned char *)delta.data(), delta.size(), [&](int i, BlockId b){
+            int y = y0 + (i >> CHUNK_SHIFT);
+            if (y < world.height()) world.set(x0 + (i & CHUNK_MASK), y, b);
+        });
+    }
+
+    void readSnapshot(BinReader &r) {
+        std::uint32_t tick = 0, baseTick = 0;
+        float day = 0.0f;
+        std::uint8_t weatherByte = 0, hasSelf = 0;
+        if (!r.get(tick) || !r.get(baseTick) || !r.get(day) || !r.get(weatherByte) || !r.get(hasSelf)) return;
+        ++snapshots;
+        if (tick <= lastTick) { ++snapshotsSkipped; return; } // llegó tarde: ya hay una más nueva
+        static const std::vector<NetEntity> none;
+        const Snapshot *base = nullptr;
+        if (baseTick != 0) {
+            base = &history[baseTick % NET_HISTORY];
+            if (base->tick != baseTick) { ++snapshotsSkipped; return; } // la base ya no está: esperar a otra
+        }
+        Snapshot &slot = history[tick % NET_HISTORY];
+        Snapshot next;
+        next.tick = tick;
+        if (hasSelf) r.get(next.self);
+        else if (base) next.self = base->self;
+        if (!read_entity_delta(r, base ? base->entities : none, next.entities)) { ++snapshotsSkipped; return; }
+        slot = std::move(next);
+        lastTick = tick;
+        prevEntities.swap(entities);
+        entities = slot.entities;
+        self = slot.self;
+        dayTime = day;
+        weather = weatherByte;
+        fresh = true;
+        sinceSnapshot.restart();
+    }
+
+    sf::TcpSocket tcp;
+    sf::UdpSocket udp;
+    sf::IpAddress server;
+    unsigned short serverPort = 0; // el mismo para TCP y UDP
+    bool online = false;
+    std::uint8_t myId = 0;
+    std::uint32_t token = 0, inputSeq = 0, lastTick = 0;
+    int worldHeight = 0, viewRadius = NET_VIEW_RADIUS, netRate = 30;
+    std::array<Snapshot, NET_HISTORY> history;
+    std::vector<NetEntity> prevEntities, entities; // snapshot anterior y última, ordenadas por id
+    NetSelf self;
+    float dayTime = 0.0f;
+    int weather = WEATHER_NONE;
+    bool fresh = false;
+    sf::Clock sinceSnapshot;
+    std::vector<char> datagram;
+};
@@ -0,0 +1,355 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "ChunkStreamer.hpp"
+#include "Net.hpp"
+#include "Simulation.hpp"
+
+// Servidor autoritativo sin ventana (--server). El mundo y los enemigos son los de siempre (World,
+// Simulation, ChunkStreamer); cada cliente conectado es un PlayerState que avanza con la entrada que
+// manda por UDP. Un tick() es un paso fijo de SIM_DT; cada 60/netRate ticks además se mandan a cada
+// cliente las columnas que le faltan, las diferencias de los chunks editados y una snapshot de las
+// entidades cercanas (ver Net.hpp para el protocolo).
+class GameServer {
+public:
+    GameServer(Simulation &sim, ChunkStreamer &streamer, int spawnX, int netRate)
+        : sim(sim), world(sim.world), streamer(streamer), spawnX(spawnX),
+          ticksPerNet(std::max(1, (int)std::lround(1.0 / (SIM_DT * std::max(1, netRate))))),
+          tokens(std::random_device{}()) {}
+
+    // Escucha en port por TCP (conexiones, chunks) y por UDP (entrada y snapshots)
+    bool listen(unsigned short port) {
+        if (listener.listen(port) != sf::Socket::Done) return false;
+        if (udp.bind(port) != sf::Socket::Done) return false;
+        listener.setBlocking(false);
+        udp.setBlocking(false);
+        return true;
+    }
+
+    void tick() {
+        auto t0 = std::chrono::steady_clock::now();
+        acceptClients();
+        receiveTcp();
+        receiveUdp();
+
+        // simular: los jugadores en orden de llegada (el primero es al que persiguen los enemigos)
+        players.clear(); inputs.clear();
+        for (auto &c : clients) if (c->joined) { players.push_back(c->state); inputs.push_back(c->input); }
+        sim.stepPlayers(players.data(), inputs.data(), (int)players.size(), SIM_DT);
+        std::size_t k = 0;
+        for (auto &c : clients) if (c->joined) { c->state = players[k++]; c->input.clearEdges(); }
+        // sin ventana no hace falta luz: nadie la dibuja aquí y cada cliente ilumina sus columnas
+        world.lightEdits.clear();
+        world.unlitColumns.clear();
+        // cada jugador mantiene cargada su ventana de columnas (el spawn si no hay nadie)
+        centers.clear();
+        for (auto &c : clients) if (c->joined) centers.push_back(playerColumn(c->state));
+        if (centers.empty()) centers.push_back(spawnX >> CHUNK_SHIFT);
+        streamer.update(world, centers.data(), (int)centers.size());
+
+        if (sim.ticks % ticksPerNet == 0) {
+            syncChunks();
+            sendSnapshots();
+        }
+        flush();
+        removeDropped();
+
+        auto ns = (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+        tickNs += ns;
+        worstTickNs = std::max(worstTickNs, ns);
+        ++tickCount;
+    }
+
+    int clientCount() const { return (int)clients.size(); }
+    int netRate() const { return (int)std::lround(1.0 / (SIM_DT * ticksPerNet)); }
+
+    // Tráfico del servidor y coste de tick() desde la última llamada a resetStats()
+    NetStats stats;
+    std::uint64_t tickNs = 0, worstTickNs = 0, tickCount = 0;
+    void resetStats() { stats = NetStats(); tickNs = worstTickNs = tickCount = 0; }
+
+private:
+    // Lo que se mandó en una snapshot, para codificar las siguientes como diferencia
+    struct Sent {
+        std::uint32_t tick = 0;
+        std::vector<NetEntity> entities;
+        NetSelf self;
+    };
+
+    struct Client {
+        sf::TcpSocket tcp;
+        std::deque<sf::Packet> outbox; // lo que el socket aún no aceptó
+        std::size_t outboxBytes = 0;
+        bool joined = false;           // ya mandó HELLO y tiene jugador
+        bool dropped = false;
+        std::uint8_t id = 0;
+        std::uint32_t token = 0;       // las entradas por UDP tienen que traerlo
+        sf::IpAddress address;
+        unsigned short udpPort = 0;
+        PlayerState state;
+        SimInput input;                // la última recibida; los flancos se guardan hasta simularlos una vez
+        std::uint32_t inputSeq = 0, ackTick = 0;
+        std::vector<int> columns;      // columnas de chunks que ya tiene
+        std::array<Sent, NET_HISTORY> history;
+    };
+
+    // Un cliente que no lee su TCP no puede acumular columnas sin límite
+    static const std::size_t OUTBOX_LIMIT = 8u << 20;
+
+    void acceptClients() {
+        for (;;) {
+            std::unique_ptr<Client> c(new Client);
+            if (listener.accept(c->tcp) != sf::Socket::Done) break;
+            int id = freeId();
+            if ((int)clients.size() >= NET_MAX_CLIENTS || id < 0) { c->tcp.disconnect(); continue; }
+            c->tcp.setBlocking(false);
+            c->id = (std::uint8_t)id;
+            c->token = tokens();
+            c->address = c->tcp.getRemoteAddress();
+            clients.push_back(std::move(c));
+        }
+    }
+
+    int freeId() const {
+        for (int id = 0; id < 256; ++id) {
+            bool used = false;
+            for (auto &c : clients) if (c->id == id) { used = true; break; }
+            if (!used) return id;
+        }
+        return -1;
+    }
+
+    void receiveTcp() {
+        for (auto &c : clients) {
+            while (!c->dropped) {
+                sf::Packet packet;
+                sf::Socket::Status st = c->tcp.receive(packet);
+                if (st == sf::Socket::NotReady || st == sf::Socket::Partial) break;
+                if (st != sf::Socket::Done) { c->dropped = true; break; }
+                BinReader r((const char *)packet.getData(), packet.getDataSize());
+                std::uint8_t type = NET_MSG_COUNT;
+                r.get(type);
+                stats.received(type, packet.getDataSize());
+                if (type == MSG_HELLO && !c->joined) hello(*c, r);
+                else c->dropped = true; // el resto de mensajes del cliente van por UDP
+            }
+        }
+    }
+
+    // HELLO: versión del protocolo y puerto UDP del cliente. Responde con WELCOME.
+    void hello(Client &c, BinReader &r) {
+        std::uint32_t protocol = 0;
+        std::uint16_t port = 0;
+        if (!r.get(protocol) || !r.get(port) || protocol != NET_PROTOCOL) { c.dropped = true; return; }
+        c.udpPort = port;
+        // aparece en el spawn o, si esa columna ya no está cargada, junto al primer jugador
+        int x = spawnX;
+        if (!world.isColumnLoaded(spawnX >> CHUNK_SHIFT))
+            for (auto &o : clients) if (o->joined) { x = (int)std::floor(o->state.p.px / TILE); break; }
+        streamer.loadNow(world, x >> CHUNK_SHIFT);
+        sim.spawnPlayerInto(c.state, x);
+        c.joined = true;
+        BinWriter w;
+        w.put((std::uint8_t)MSG_WELCOME); w.put(c.id); w.put(c.token);
+        w.put((std::int32_t)world.height()); w.put((std::int32_t)NET_VIEW_RADIUS); w.put((std::int32_t)netRate());
+        queue(c, w);
+        std::cout << "Cliente " << (int)c.id << " conectado desde " << c.address << " (" << clients.size() << " en total)" << std::endl;
+    }
+
+    // INPUT: id, token, secuencia, último tick de snapshot recibido y el SimInput
+    void receiveUdp() {
+        char buf[1024];
+        for (;;) {
+            std::size_t n = 0;
+            sf::IpAddress from;
+            unsigned short port = 0;
+            if (udp.receive(buf, sizeof(buf), n, from, port) != sf::Socket::Done) break;
+            BinReader r(buf, n);
+            std::uint8_t type = NET_MSG_COUNT, id = 0;
+            std::uint32_t token = 0, seq = 0, ack = 0;
+            r.get(type);
+            stats.received(type, n);
+            if (type != MSG_INPUT || !r.get(id) || !r.get(token) || !r.get(seq) || !r.get(ack)) continue;
+            Client *c = nullptr;
+            for (auto &o : clients) if (o->joined && o->id == id) { c = o.get(); break; }
+            if (!c || c->token != token || c->address != from || seq <= c->inputSeq) continue; // ajena, falsa o atrasada
+            SimInput in;
+            InputLog::readInput(r, in);
+            if (!r.good()) continue;
+            // si llegan dos entradas en el mismo tick, no perder los flancos de la primera
+            const SimInput &old = c->input;
+            in.jump |= old.jump; in.placeFacing |= old.placeFacing; in.swing |= old.swing; in.toggleWeather |= old.toggleWeather;
+            if (old.placeAt && !in.placeAt) { in.placeAt = true; in.placeTileX = old.placeTileX; in.placeTileY = old.placeTileY; }
+            if (in.selectBlock < 0) in.selectBlock = old.selectBlock;
+            if (in.selectTool == TOOL_NONE) in.selectTool = old.selectTool;
+            c->input = in;
+            c->inputSeq = seq;
+            if (ack <= (std::uint32_t)sim.ticks) c->ackTick = std::max(c->ackTick, ack);
+        }
+    }
+
+    static int playerColumn(const PlayerState &ps) {
+        return (int)std::floor((ps.p.px + ps.p.w * 0.5f) / TILE) >> CHUNK_SHIFT;
+    }
+
+    static bool has(const Client &c, int cx) {
+        return std::find(c.columns.begin(), c.columns.end(), cx) != c.columns.end();
+    }
+
+    // Copia de lo último que se mandó de cada chunk: el bit CHUNK_DIRTY_NET dice qué chunks comparar
+    std::vector<Chunk> &shadowOf(int cx) {
+        auto it = shadows.find(cx);
+        if (it != shadows.end()) return it->second;
+        std::vector<Chunk> &col = shadows[cx];
+        for (int cy = 0; cy < world.chunksY(); ++cy) {
+            col.emplace_back(cx, cy, (BlockId)AIR);
+            if (Chunk *c = world.chunkAt(cx, cy)) { col.back().blocks = c->blocks; c->dirty &= (std::uint8_t)~CHUNK_DIRTY_NET; }
+        }
+        return col;
+    }
+
+    void syncChunks() {
+        // 1. lo editado desde la última vez, a quien tenga la columna
+        std::vector<unsigned char> delta;
+        for (auto it = shadows.begin(); it != shadows.end();) {
+            const int cx = it->first;
+            if (!world.isColumnLoaded(cx)) { it = shadows.erase(it); continue; }
+            for (int cy = 0; cy < world.chunksY(); ++cy) {
+                Chunk *c = world.chunkAt(cx, cy);
+                if (!c || !(c->dirty & CHUNK_DIRTY_NET)) continue;
+                c->dirty &= (std::uint8_t)~CHUNK_DIRTY_NET;
+                Chunk &shadow = it->second[cy];
+                encode_chunk_delta(shadow.blocks.data(), c->blocks.data(), delta);
+                if (delta.empty()) continue;
+                shadow.blocks = c->blocks;
+                BinWriter w;
+                w.put((std::uint8_t)MSG_CHUNK_DELTA); w.put((std::int32_t)cx); w.put((std::int32_t)cy);
+                w.putString(std::string(delta.begin(), delta.end()));
+                for (auto &cl : clients) if (cl->joined && has(*cl, cx)) queue(*cl, w);
+            }
+            ++it;
+        }
+
+        // 2. columnas que salen o entran en la zona de cada cliente
+        std::vector<unsigned char> rle;
+        for (auto &c : clients) {
+            if (!c->joined) continue;
+            const int pcx = playerColumn(c->state);
+            for (std::size_t i = 0; i < c->columns.size();) {
+                int cx = c->columns[i];
+                if (world.isColumnLoaded(cx) && std::abs(cx - pcx) <= NET_VIEW_RADIUS + 1) { ++i; continue; }
+                BinWriter w;
+                w.put((std::uint8_t)MSG_COLUMN_DROP); w.put((std::int32_t)cx);
+                queue(*c, w);
+                c->columns[i] = c->columns.back();
+                c->columns.pop_back();
+            }
+            for (int d = 0; d <= NET_VIEW_RADIUS; ++d) {
+                for (int cx : {pcx - d, pcx + d}) {
+                    if (!world.isColumnLoaded(cx) || has(*c, cx)) continue;
+                    std::vector<Chunk> &shadow = shadowOf(cx);
+                    BinWriter w;
+                    w.put((std::uint8_t)MSG_COLUMN); w.put((std::int32_t)cx); w.put((std::uint16_t)shadow.size());
+                    for (int cy = 0; cy < (int)shadow.size(); ++cy) {
+                        // cadena vacía: chunk sin reservar (todo aire)
+                        if (world.chunkAt(cx, cy)) RegionStore::encode(shadow[cy], rle); else rle.clear();
+                        w.putString(std::string(rle.begin(), rle.end()));
+                    }
+                    queue(*c, w);
+                    c->columns.push_back(cx);
+                    if (d == 0) break;
+                }
+            }
+        }
+    }
+
+    // SNAPSHOT: tick, tick base, hora del día, clima, estado propio si cambió y las entidades en diferencia
+    void sendSnapshots() {
+        const std::uint32_t tick = (std::uint32_t)sim.ticks;
+        std::vector<NetEntity> cur;
+        const std::vector<NetEntity> none;
+        for (auto &c : clients) {
+            if (!c->joined) continue;
+            const Player &me = c->state.p;
+            auto near = [&](float x, float y){ return std::fabs(x - me.px) < NET_ENTITY_RANGE && std::fabs(y - me.py) < NET_ENTITY_RANGE; };
+            cur.clear();
+            for (auto &o : clients) if (o->joined && near(o->state.p.px, o->state.p.py)) cur.push_back(NetEntity::fromPlayer(o->id, o->state.p));
+            std::sort(cur.begin(), cur.end(), [](const NetEntity &a, const NetEntity &b){ return a.id < b.id; });
+            for (std::size_t i = 0; i < sim.enemies.size(); ++i) {
+                const Enemy &e = sim.enemies[i];
+                if (e.alive && near(e.x, e.y)) cur.push_back(NetEntity::fromEnemy((int)i, e));
+            }
+            sim.items.forEach([&](int i, const ItemPool::Item &it){ if (near(it.x, it.y)) cur.push_back(NetEntity::fromItem(i, it)); });
+            const NetSelf self = NetSelf::from(c->state);
+
+            const Sent &acked = c->history[c->ackTick % NET_HISTORY];
+            const Sent *base = (c->ackTick != 0 && acked.tick == c->ackTick) ? &acked : nullptr;
+            const bool sendSelf = !base || !(base->self == self);
+            BinWriter w;
+            w.put((std::uint8_t)MSG_SNAPSHOT); w.put(tick); w.put(base ? base->tick : 0u);
+            w.put(sim.dayTime); w.put((std::uint8_t)sim.weatherMode);
+            w.put((std::uint8_t)(sendSelf ? 1 : 0));
+            if (sendSelf) w.put(self);
+            write_entity_delta(w, base ? base->entities : none, cur);
+
+            Sent &slot = c->history[tick % NET_HISTORY];
+            slot.tick = tick; slot.entities = cur; slot.self = self;
+            const std::vector<char> &data = w.data();
+            if (udp.send(data.data(), data.size(), c->address, c->udpPort) == sf::Socket::Done) stats.sent(MSG_SNAPSHOT, data.size());
+        }
+    }
+
+    void queue(Client &c, const BinWriter &w) {
+        const std::vector<char> &data = w.data();
+        sf::Packet packet;
+        packet.append(data.data(), data.size());
+        c.outbox.push_back(packet);
+        c.outboxBytes += data.size();
+        stats.sent((std::uint8_t)data[0], data.size());
+        if (c.outboxBytes > OUTBOX_LIMIT) c.dropped = true;
+    }
+
+    void flush() {
+        for (auto &c : clients) {
+            while (!c->dropped && !c->outbox.empty()) {
+                sf::Socket::Status st = c->tcp.send(c->outbox.front());
+                if (st == sf::Socket::Partial || st == sf::Socket::NotReady) break; // SFML recuerda lo ya enviado del paquete
+                if (st != sf::Socket::Done) { c->dropped = true; break; }
+                c->outboxBytes -= c->outbox.front().getDataSize();
+                c->outbox.pop_front();
+            }
+        }
+    }
+
+    void removeDropped() {
+        for (std::size_t i = 0; i < clients.size();) {
+            if (!clients[i]->dropped) { ++i; continue; }
+            if (clients[i]->joined) std::cout << "Cliente " << (int)clients[i]->id << " desconectado (" << clients.size() - 1 << " en total)" << std::endl;
+            clients.erase(clients.begin() + i);
+        }
+    }
+
+    Simulation &sim;
+    World &world;
+    ChunkStreamer &streamer;
+    const int spawnX;
+    const int ticksPerNet;
+    std::mt19937 tokens;
+    sf::TcpListener listener;
+    sf::UdpSocket udp;
+    std::vector<std::unique_ptr<Client>> clients; // en orden de llegada
+    std::vector<PlayerState> players;
+    std::vector<SimInput> inputs;
+    std::vector<int> centers;                     // columna de cada jugador, para el streamer
+    std::unordered_map<int, std::vector<Chunk>> shadows;
+};
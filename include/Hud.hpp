@@ -0,0 +1,215 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <string>
+#include "Simulation.hpp"
+#include "SpriteAtlas.hpp"
+
+// Lo que muestra el HUD. Si no cambia nada de esto, el HUD del frame anterior sigue valiendo.
+struct HudState {
+    int health = -1;
+    bool invuln = false;
+    Tool selectedTool = TOOL_NONE;
+    BlockId selected = AIR;
+    int selectedCount = 0;
+    std::array<int, HOTBAR_SIZE> counts{};
+    bool picker = false, help = false;
+    int fps = 0;
+    int assets = 0; // sube al cambiar la fuente o el atlas
+
+    static HudState capture(const Simulation &sim, bool picker, bool help, int fps, int assets) {
+        HudState s;
+        s.health = sim.playerHealth;
+        s.invuln = sim.playerInvuln > 0.0f;
+        s.selectedTool = sim.p.selectedTool;
+        s.selected = sim.p.selected;
+        s.selectedCount = sim.p.inv[sim.p.selected];
+        for (int i = 0; i < HOTBAR_SIZE; ++i) s.counts[i] = sim.p.inv[HOTBAR[i]];
+        s.picker = picker; s.help = help; s.fps = fps; s.assets = assets;
+        return s;
+    }
+
+    bool operator==(const HudState &o) const {
+        return health == o.health && invuln == o.invuln && selectedTool == o.selectedTool && selected == o.selected
+            && selectedCount == o.selectedCount && counts == o.counts && picker == o.picker && help == o.help
+            && fps == o.fps && assets == o.assets;
+    }
+    bool operator!=(const HudState &o) const { return !(*this == o); }
+};
+
+// HUD en modo retenido: se compone entero en una RenderTexture solo cuando cambia el HudState (una
+// cantidad, la vida, la selección, el FPS mostrado...), y el resto de frames es un único quad.
+class Hud {
+public:
+    static constexpr int INV_SLOTS = 12; // inventory slots shown at bottom
+
+    // viewW x viewH: zona del mundo en píxeles; el panel inferior ocupa barH píxeles debajo
+    Hud(const sf::Font &font, const SpriteAtlas &atlas, const SpriteId *toolSprites, float viewW, float viewH, float barH)
+        : font(font), atlas(atlas), toolSprites(toolSprites), viewW(viewW), viewH(viewH), barH(barH) {
+        target.create((unsigned)viewW, (unsigned)(viewH + barH));
+    }
+
+    // Dibuja el HUD en window (con su vista por defecto); recompone antes si el estado cambió
+    void draw(sf::RenderTarget &window, const HudState &s) {
+        if (!composed || s != last) { compose(s); last = s; composed = true; ++composeCount; }
+        // la textura ya lleva el alfa multiplicado, así que se mezcla con One / OneMinusSrcAlpha
+        sf::Sprite quad(target.getTexture());
+        window.draw(quad, sf::RenderStates(sf::BlendMode(sf::BlendMode::One, sf::BlendMode::OneMinusSrcAlpha)));
+    }
+
+    unsigned long composeCount = 0; // veces que se ha recompuesto (para medir)
+
+private:
+    sf::Text text(const std::string &str, unsigned size, sf::Color color, float x, float y) const {
+        sf::Text t(str, font, size);
+        t.setFillColor(color);
+        t.setPosition(x, y);
+        return t;
+    }
+
+    void compose(const HudState &s) {
+        target.clear(sf::Color::Transparent);
+        sf::RectangleShape hudBg(sf::Vector2f(viewW, barH));
+        hudBg.setPosition(0, viewH);
+        hudBg.setFillColor(sf::Color(30,30,30,200));
+        target.draw(hudBg);
+
+        // Draw player hearts
+        const float heartSize = 20.0f;
+        for (int i = 0; i < MAX_HEALTH; ++i) {
+            sf::RectangleShape heart(sf::Vector2f(heartSize, heartSize));
+            heart.setPosition(10 + i * (heartSize + 6), 8); // hearts at top
+            if (i < s.health) heart.setFillColor(sf::Color(220,30,30));
+            else { heart.setFillColor(sf::Color(80,80,80)); heart.setOutlineThickness(2); heart.setOutlineColor(sf::Color(30,30,30)); }
+            // flash when invulnerable
+            if (s.invuln) { sf::Color c = heart.getFillColor(); c.a = 180; heart.setFillColor(c); }
+            target.draw(heart);
+        }
+
+        // tools HUD: show pickaxe/axe/shovel with keys Q/E/R below hearts
+        static const char TOOL_HOTKEYS[TOOL_COUNT] = { 0, 'Q', 'E', 'R', 'T' };
+        for (int tool = TOOL_PICKAXE; tool < TOOL_COUNT; ++tool){
+            int ti = tool - TOOL_PICKAXE;
+            sf::RectangleShape tslot(sf::Vector2f(36,36));
+            tslot.setPosition(10 + ti*42, 40);
+            tslot.setFillColor(sf::Color(0,0,0,160));
+            target.draw(tslot);
+            target.draw(text(std::string(1,TOOL_HOTKEYS[tool]) + ":" + std::string(TOOL_KEYS[tool]).substr(0,3), 14, sf::Color::White, 14 + ti*42, 42));
+            // highlight selected tool
+            if (s.selectedTool == tool){
+                sf::RectangleShape high(sf::Vector2f(40,40));
+                high.setPosition(8 + ti*42, 38);
+                high.setFillColor(sf::Color(255,255,255,40));
+                target.draw(high);
+            }
+        }
+
+        // Selected tool/block panel (top-right) - improved layout to avoid overlapping text
+        {
+            float px = viewW - 280.0f;
+            float py = 8.0f;
+            sf::RectangleShape panel(sf::Vector2f(268.0f, 96.0f));
+            panel.setPosition(px, py);
+            panel.setFillColor(sf::Color(20,20,20,220));
+            panel.setOutlineThickness(2); panel.setOutlineColor(sf::Color(80,80,80));
+            target.draw(panel);
+            // selected block big slot
+            sf::RectangleShape bslot(sf::Vector2f(64,64));
+            bslot.setPosition(px + 8, py + 12);
+            bslot.setFillColor(block_color(s.selected));
+            bslot.setOutlineThickness(2); bslot.setOutlineColor(sf::Color::Black);
+            target.draw(bslot);
+            target.draw(text(BLOCKS[s.selected].name, 18, sf::Color::White, px + 82, py + 16));
+            target.draw(text(std::to_string(s.selectedCount), 16, sf::Color::White, px + 82, py + 40));
+            // tool area label and content (separated lines to avoid overlap)
+            target.draw(text("Herramienta:", 13, sf::Color::White, px + 82, py + 56));
+            // draw tool icon if available, else draw name on its own line
+            const SpriteId toolSprite = toolSprites[s.selectedTool];
+            if (toolSprite != NO_SPRITE) {
+                const sf::IntRect &tr = atlas.rect(toolSprite);
+                sf::Sprite ts(atlas.texture(), tr);
+                ts.setScale(48.0f / (float)tr.width, 48.0f / (float)tr.height);
+                ts.setPosition(px + 188, py + 24);
+                target.draw(ts);
+                // also draw name below the label for clarity
+                target.draw(text(TOOL_NAMES[s.selectedTool], 14, sf::Color::White, px + 82, py + 74));
+            } else {
+                target.draw(text(TOOL_NAMES[s.selectedTool], 16, sf::Color::White, px + 82, py + 72));
+            }
+        }
+
+        // inventory (extendido con hojas, minerales y nuevos bloques)
+        for (int i = 0; i < std::min(HOTBAR_SIZE, INV_SLOTS); ++i){
+            BlockId b = HOTBAR[i];
+            sf::RectangleShape slot(sf::Vector2f(56,56));
+            slot.setPosition(10 + i*66, viewH + 16);
+            slot.setFillColor(block_color(b));
+            if (b == s.selected) { slot.setOutlineThickness(3); slot.setOutlineColor(sf::Color::Yellow); }
+            else { slot.setOutlineThickness(1); slot.setOutlineColor(sf::Color::Black); }
+            target.draw(slot);
+            target.draw(text(std::to_string(s.counts[i]), 16, sf::Color::White, 10 + i*66 + 34, viewH + 56));
+        }
+
+        // block picker overlay
+        if (s.picker) {
+            // darken background
+            sf::RectangleShape dark(sf::Vector2f(viewW, viewH));
+            dark.setFillColor(sf::Color(0,0,0,140));
+            target.draw(dark);
+            // draw centered panel with block options
+            int cols = 4; int rows = (HOTBAR_SIZE + cols - 1) / cols;
+            float slotW = 80.0f, slotH = 80.0f, gap = 12.0f;
+            float panelW = cols * slotW + (cols-1)*gap;
+            float panelH = rows * slotH + (rows-1)*gap;
+            float startX = viewW * 0.5f - panelW*0.5f; float startY = viewH * 0.5f - panelH*0.5f;
+            for (int i = 0; i < HOTBAR_SIZE; ++i){
+                float sx = startX + (i % cols) * (slotW + gap);
+                float sy = startY + (i / cols) * (slotH + gap);
+                sf::RectangleShape slot(sf::Vector2f(slotW, slotH));
+                slot.setPosition(sx, sy);
+                slot.setFillColor(block_color(HOTBAR[i]));
+                slot.setOutlineThickness(2); slot.setOutlineColor(sf::Color::White);
+                target.draw(slot);
+                target.draw(text(BLOCKS[HOTBAR[i]].name, 14, sf::Color::Black, sx + 8, sy + 8));
+            }
+        }
+
+        // Help panel (toggle with H)
+        if (s.help) {
+            static const char *const HELP_LINES[] = {
+                "Controles:",
+                "A/D: mover    W/Espacio: saltar",
+                "X: picar (mantener)    C/Dcho: colocar",
+                "Q: Pico    E: Hacha    R: Pala    T: Espada",
+                "1-0: seleccionar bloques    F: elegir bloque (overlay)",
+                "K: alternar clima    B: soltar pelota    F5: guardar",
+                "H: cerrar esta ayuda"
+            };
+            const int lines = (int)(sizeof(HELP_LINES) / sizeof(HELP_LINES[0]));
+            float panelW = 560.0f;
+            float lineH = 22.0f;
+            float panelH = lines * lineH + 20.0f;
+            float startX = (viewW - panelW) * 0.5f;
+            float startY = (viewH - panelH) * 0.5f;
+            sf::RectangleShape panel(sf::Vector2f(panelW, panelH));
+            panel.setPosition(startX, startY);
+            panel.setFillColor(sf::Color(10,10,10,220));
+            panel.setOutlineThickness(2); panel.setOutlineColor(sf::Color(120,120,120));
+            target.draw(panel);
+            for (int i = 0; i < lines; ++i) target.draw(text(HELP_LINES[i], 18, sf::Color::White, startX + 12.0f, startY + 8.0f + i * lineH));
+        }
+
+        // FPS
+        target.draw(text(std::to_string(s.fps) + " FPS", 14, sf::Color::White, viewW - 90.f, viewH + 4.f));
+        target.display();
+    }
+
+    const sf::Font &font;
+    const SpriteAtlas &atlas;
+    const SpriteId *toolSprites;
+    float viewW, viewH, barH;
+    sf::RenderTexture target;
+    HudState last;
+    bool composed = false;
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "RegionStore.hpp"
+#include "Simulation.hpp"
+
+// Grabación de una partida para reproducirla paso a paso: la semilla, la altura y el radio del mundo, la entrada
+// de cada tick de simulación y los ticks en que se cargó o descargó cada columna (el streamer lo hace en
+// segundo plano, así que sin esto el mundo de la reproducción no sería el mismo).
+// Con Simulation::seedRandom y la misma entrada, la reproducción da el mismo estado bit a bit
+// (compararlo con Simulation::stateHash).
+// La entrada se guarda en tramos: un SimInput y cuántos ticks seguidos se repite. Solo lleva lo que lee la
+// simulación; lo que depende de la cámara (la zona del clima) se deduce de la posición del jugador.
+class InputLog {
+public:
+    struct ColumnEvent {
+        std::uint64_t tick; // se aplica antes de ese tick
+        std::int32_t cx;
+        std::uint8_t load;  // 1 = cargar, 0 = descargar
+    };
+
+    std::uint32_t seed = 0;
+    std::int32_t height = 0;
+    std::int32_t radius = 0; // radio del streamer: fija la capacidad del anillo de columnas de World
+
+    // Grabar
+    void push(const SimInput &in) {
+        // las casillas del ratón solo cuentan con su botón pulsado: sin él no rompen los tramos
+        SimInput used = in;
+        if (!used.mouseLeft) used.mouseTileX = used.mouseTileY = 0;
+        if (!used.placeAt) used.placeTileX = used.placeTileY = 0;
+        if (!runs.empty() && same(runs.back().input, used)) ++runs.back().count;
+        else runs.push_back({used, 1});
+        ++tickCount;
+    }
+    void column(std::uint64_t tick, int cx, bool load) { columns.push_back({tick, cx, (std::uint8_t)(load ? 1 : 0)}); }
+
+    std::uint64_t ticks() const { return tickCount; }
+    const std::vector<ColumnEvent> &columnEvents() const { return columns; }
+
+    // Entrada del tick t (en orden creciente: recorre los tramos sin volver atrás)
+    const SimInput &input(std::uint64_t t) {
+        while (cursorStart + runs[cursor].count <= t) { cursorStart += runs[cursor].count; ++cursor; }
+        return runs[cursor].input;
+    }
+
+    bool save(const std::string &path) const {
+        BinWriter w;
+        w.put(MAGIC); w.put(VERSION); w.put(seed); w.put(height); w.put(radius);
+        w.put((std::uint32_t)runs.size());
+        for (const Run &r : runs) { w.put(r.count); writeInput(w, r.input); }
+        w.put((std::uint32_t)columns.size());
+        for (const ColumnEvent &c : columns) { w.put(c.tick); w.put(c.cx); w.put(c.load); }
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(w.data().data(), (std::streamsize)w.data().size());
+        return (bool)out;
+    }
+
+    bool load(const std::string &path) {
+        std::ifstream f(path, std::ios::binary);
+        if (!f) return false;
+        std::vector<char> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+        BinReader r(data.data(), data.size());
+        std::uint32_t magic = 0, version = 0, n = 0;
+        if (!r.get(magic) || magic != MAGIC || !r.get(version) || version != VERSION) return false;
+        r.get(seed); r.get(height); r.get(radius);
+        runs.clear(); columns.clear(); tickCount = 0; cursor = 0; cursorStart = 0;
+        r.get(n);
+        for (std::uint32_t i = 0; i < n && r.good(); ++i) {
+            Run run; r.get(run.count); readInput(r, run.input);
+            runs.push_back(run);
+            tickCount += run.count;
+        }
+        n = 0; r.get(n);
+        for (std::uint32_t i = 0; i < n && r.good(); ++i) {
+            ColumnEvent c; r.get(c.tick); r.get(c.cx); r.get(c.load);
+            columns.push_back(c);
+        }
+        return r.good();
+    }
+
+    // Un SimInput en binario (también es el formato de la entrada que los clientes mandan al servidor)
+    static void writeInput(BinWriter &w, const SimInput &in) {
+        w.put(buttons(in));
+        w.put((std::int32_t)in.mouseTileX); w.put((std::int32_t)in.mouseTileY);
+        w.put((std::int32_t)in.placeTileX); w.put((std::int32_t)in.placeTileY);
+        w.put((std::int32_t)in.selectBlock); w.put((std::uint8_t)in.selectTool);
+    }
+
+    static void readInput(BinReader &r, SimInput &in) {
+        std::uint16_t b = 0; std::int32_t mx = 0, my = 0, px = 0, py = 0, sb = -1; std::uint8_t tool = 0;
+        r.get(b); r.get(mx); r.get(my); r.get(px); r.get(py); r.get(sb); r.get(tool);
+        in.moveLeft = b & 1; in.moveRight = b & 2; in.jump = b & 4; in.breakFacing = b & 8; in.mouseLeft = b & 16;
+        in.placeFacing = b & 32; in.placeAt = b & 64; in.swing = b & 128; in.toggleWeather = b & 256;
+        in.mouseTileX = mx; in.mouseTileY = my; in.placeTileX = px; in.placeTileY = py;
+        in.selectBlock = sb; in.selectTool = tool < TOOL_COUNT ? (Tool)tool : TOOL_NONE;
+    }
+
+private:
+    static constexpr std::uint32_t MAGIC = 0x4932434D; // "MC2I"
+    static constexpr std::uint32_t VERSION = 1;
+
+    struct Run {
+        SimInput input;
+        std::uint32_t count;
+    };
+
+    // Botones en una máscara; el resto, campo a campo
+    static std::uint16_t buttons(const SimInput &in) {
+        return (std::uint16_t)(in.moveLeft | in.moveRight << 1 | in.jump << 2 | in.breakFacing << 3 | in.mouseLeft << 4
+            | in.placeFacing << 5 | in.placeAt << 6 | in.swing << 7 | in.toggleWeather << 8);
+    }
+
+    static bool same(const SimInput &a, const SimInput &b) {
+        return buttons(a) == buttons(b) && a.mouseTileX == b.mouseTileX && a.mouseTileY == b.mouseTileY
+            && a.placeTileX == b.placeTileX && a.placeTileY == b.placeTileY && a.selectBlock == b.selectBlock
+            && a.selectTool == b.selectTool;
+    }
+
+    std::vector<Run> runs;
+    std::vector<ColumnEvent> columns;
+    std::uint64_t tickCount = 0;
+    std::size_t cursor = 0;
+    std::uint64_t cursorStart = 0;
+};
@@ -0,0 +1,294 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Collision.hpp"
+#include "World.hpp"
+
+// Bloques soltados (al picar, restos de una explosión) que esperan en el suelo a que alguien los recoja.
+// Pool de capacidad fija: todo se reserva al crearlo, así que una explosión que suelta cientos no reserva
+// memoria; si se llena, el nuevo sustituye al que antes iba a desaparecer. Una lista enlazada ordenada por
+// instante de caducidad da ese objeto, y los que caducan, sin recorrer el pool.
+// Un objeto está despierto (cae y se desliza con move_body, como jugador y enemigos) o dormido: parado en
+// el suelo no cuesta nada por tick hasta que cambia un tile junto a él (World::fallEdits, que step() lee
+// antes de que FallingBlocks lo vacíe). Al pararse se junta con un montón cercano del mismo bloque.
+// Los vecinos se buscan en una rejilla intrusiva: cubos de celdas enlazados por índice, sin reservas.
+class ItemPool {
+public:
+    static constexpr float SIZE = 12.0f;          // px de lado
+    static constexpr float CELL = 64.0f;          // px de celda de la rejilla
+    static constexpr float MERGE_RADIUS = 20.0f;  // px entre centros para juntar dos montones
+    static constexpr float LIFETIME = 300.0f;     // s hasta que desaparece
+    static constexpr float PICKUP_DELAY = 0.4f;   // s antes de poder recogerlo (que se vea saltar)
+    static constexpr int REST_TICKS = 8;           // ticks parado en el suelo antes de dormirse
+    static constexpr int MAX_COUNT = 64;           // bloques por montón
+
+    struct Item {
+        float x, y, vx, vy, w, h; // cuerpo para move_body
+        float prevX, prevY;       // posición del paso anterior, para interpolar al dibujar
+        float expires;            // instante (time()) en que desaparece
+        float pickupAt;           // instante desde el que se puede recoger
+        BlockId block;
+        std::uint8_t state;       // ITEM_FREE, ITEM_AWAKE, ITEM_ASLEEP
+        std::uint16_t count;
+        std::uint8_t rest;        // ticks seguidos parado
+        int awakeSlot;            // posición en la lista de despiertos
+        int cellX, cellY, next, prev; // rejilla: celda y enlaces del cubo
+        int older, newer;         // lista por caducidad
+    };
+    enum : std::uint8_t { ITEM_FREE = 0, ITEM_AWAKE, ITEM_ASLEEP };
+
+    explicit ItemPool(std::size_t capacity) : items(capacity) {
+        std::size_t buckets = 64;
+        while (buckets < capacity * 2) buckets <<= 1;
+        heads.assign(buckets, -1);
+        freeIds.reserve(capacity);
+        awake.reserve(capacity);
+        for (std::size_t i = capacity; i-- > 0;) freeIds.push_back((int)i);
+        for (Item &it : items) it.state = ITEM_FREE;
+    }
+
+    std::size_t count() const { return items.size() - freeIds.size(); }
+    std::size_t awakeCount() const { return awake.size(); }
+    std::size_t capacity() const { return items.size(); }
+    float time() const { return now; }
+
+    // Suelta count bloques b con la esquina en (x, y); devuelve su índice
+    int spawn(float x, float y, BlockId b, int n, float vx, float vy) {
+        int id;
+        if (!freeIds.empty()) { id = freeIds.back(); freeIds.pop_back(); }
+        else { id = oldest; unlink(id); unlinkAge(id); if (items[id].state == ITEM_AWAKE) removeAwake(id); }
+        Item &it = items[id];
+        it.x = it.prevX = x; it.y = it.prevY = y; it.vx = vx; it.vy = vy; it.w = it.h = SIZE;
+        it.expires = now + LIFETIME; it.pickupAt = now + PICKUP_DELAY;
+        it.block = b; it.count = (std::uint16_t)std::max(1, std::min(MAX_COUNT, n)); it.rest = 0;
+        it.state = ITEM_ASLEEP;
+        link(id);
+        linkAge(id, newest); // nadie caduca después: LIFETIME es fijo y now solo avanza
+        wake(id);
+        return id;
+    }
+
+    // Coloca un objeto dormido tal cual (copia del de otra simulación: la snapshot del servidor)
+    void put(float x, float y, float prevX, float prevY, BlockId b, int n) {
+        int id = spawn(x, y, b, n, 0.0f, 0.0f);
+        removeAwake(id);
+        items[id].state = ITEM_ASLEEP;
+        items[id].prevX = prevX; items[id].prevY = prevY;
+    }
+
+    // Vacía el pool (sin liberar memoria)
+    void clear() {
+        freeIds.clear();
+        for (std::size_t i = items.size(); i-- > 0;) { items[i].state = ITEM_FREE; freeIds.push_back((int)i); }
+        awake.clear();
+        std::fill(heads.begin(), heads.end(), -1);
+        oldest = newest = -1;
+    }
+
+    void savePrevious() {
+        for (int id : awake) { items[id].prevX = items[id].x; items[id].prevY = items[id].y; }
+    }
+
+    // Un paso: despierta lo que tiene tiles cambiados al lado, mueve los despiertos con gravedad y
+    // rozamiento, duerme (juntándolos) los que se paran y quita los caducados
+    void step(const World &world, float dt, float gravity, float maxFall) {
+        now += dt;
+        for (const auto &e : world.fallEdits) {
+            float tx = (float)e.first * TILE, ty = (float)e.second * TILE;
+            forEachIn(tx - SIZE, ty - SIZE, tx + TILE + SIZE, ty + TILE + SIZE, [&](int id){ if (items[id].state == ITEM_ASLEEP) wake(id); });
+        }
+        const float killY = (float)world.height() * TILE + 2.0f * TILE;
+        for (std::size_t k = 0; k < awake.size();) {
+            int id = awake[k];
+            Item &it = items[id];
+            it.vy = std::min(maxFall, it.vy + gravity * dt);
+            move_body(world, it, dt);
+            if (it.y > killY) { release(id); continue; } // cayó por debajo del mundo
+            // en reposo move_body solo marca CONTACT_GROUND un tick de cada dos: se mira el suelo como el jugador
+            const bool grounded = on_ground(world, it);
+            if (grounded) {
+                it.vx *= std::max(0.0f, 1.0f - GROUND_FRICTION * dt);
+                if (std::fabs(it.vx) < 4.0f) it.vx = 0.0f;
+            }
+            relink(id);
+            if (grounded && it.vx == 0.0f) {
+                if (++it.rest >= REST_TICKS && settle(id)) continue; // se durmió (o se juntó con otro): ya no está en awake[k]
+            } else it.rest = 0;
+            ++k;
+        }
+        while (oldest != -1 && items[oldest].expires <= now) release(oldest);
+    }
+
+    // Recoge lo que hay a menos de radius de (cx, cy): take(bloque, cantidad) devuelve cuántos se queda
+    // (lo que no cabe se queda en el suelo). Devuelve los bloques recogidos.
+    template <class F>
+    int collect(float cx, float cy, float radius, F &&take) {
+        int total = 0;
+        forEachIn(cx - radius, cy - radius, cx + radius, cy + radius, [&](int id){
+            const Item &it = items[id];
+            if (it.pickupAt > now || std::hypot(it.x + it.w * 0.5f - cx, it.y + it.h * 0.5f - cy) > radius) return;
+            total += takeFrom(id, take);
+        });
+        for (int id : pendingRelease) release(id);
+        pendingRelease.clear();
+        return total;
+    }
+
+    // Como collect, pero de todos los que hay, estén donde estén (al guardar la partida)
+    template <class F>
+    int collectAll(F &&take) {
+        int total = 0;
+        for (std::size_t id = 0; id < items.size(); ++id)
+            if (items[id].state != ITEM_FREE) total += takeFrom((int)id, take);
+        for (int id : pendingRelease) release(id);
+        pendingRelease.clear();
+        return total;
+    }
+
+    // f(item, x, y) para los objetos del rectángulo (px), en la posición interpolada con lerp
+    template <class F>
+    void forEachVisible(float x0, float y0, float x1, float y1, float lerp, F &&f) const {
+        forEachIn(x0 - SIZE, y0 - SIZE, x1, y1, [&](int id){
+            const Item &it = items[id];
+            f(it, it.prevX + (it.x - it.prevX) * lerp, it.prevY + (it.y - it.prevY) * lerp);
+        });
+    }
+
+    // f(índice, item) para todos los que hay, en orden de índice (el recorrido es reproducible)
+    template <class F>
+    void forEach(F &&f) const {
+        for (std::size_t i = 0; i < items.size(); ++i) if (items[i].state != ITEM_FREE) f((int)i, items[i]);
+    }
+
+private:
+    static constexpr float GROUND_FRICTION = 8.0f; // 1/s: cuánto frena al deslizarse por el suelo
+
+    int cellOf(float v) const { return (int)std::floor(v / CELL); }
+    std::size_t bucket(int cx, int cy) const {
+        return (std::size_t)(((std::uint64_t)(std::uint32_t)cx * 0x9E3779B1u ^ (std::uint64_t)(std::uint32_t)cy * 0x85EBCA77u) & (heads.size() - 1));
+    }
+
+    // f(id) para cada objeto cuya celda toca el rectángulo; las celdas que comparten cubo se filtran por celda
+    template <class F>
+    void forEachIn(float x0, float y0, float x1, float y1, F &&f) const {
+        int cx0 = cellOf(x0), cy0 = cellOf(y0), cx1 = cellOf(x1), cy1 = cellOf(y1);
+        for (int cy = cy0; cy <= cy1; ++cy)
+            for (int cx = cx0; cx <= cx1; ++cx)
+                for (int id = heads[bucket(cx, cy)]; id != -1;) {
+                    int nextId = items[id].next; // f puede soltar este objeto
+                    if (items[id].cellX == cx && items[id].cellY == cy) f(id);
+                    id = nextId;
+                }
+    }
+
+    void link(int id) {
+        Item &it = items[id];
+        it.cellX = cellOf(it.x + it.w * 0.5f); it.cellY = cellOf(it.y + it.h * 0.5f);
+        int &head = heads[bucket(it.cellX, it.cellY)];
+        it.prev = -1; it.next = head;
+        if (head != -1) items[head].prev = id;
+        head = id;
+    }
+
+    void unlink(int id) {
+        Item &it = items[id];
+        if (it.prev != -1) items[it.prev].next = it.next;
+        else heads[bucket(it.cellX, it.cellY)] = it.next;
+        if (it.next != -1) items[it.next].prev = it.prev;
+    }
+
+    void relink(int id) {
+        const Item &it = items[id];
+        if (cellOf(it.x + it.w * 0.5f) == it.cellX && cellOf(it.y + it.h * 0.5f) == it.cellY) return;
+        unlink(id);
+        link(id);
+    }
+
+    void wake(int id) {
+        Item &it = items[id];
+        it.state = ITEM_AWAKE;
+        it.rest = 0;
+        it.awakeSlot = (int)awake.size();
+        awake.push_back(id);
+    }
+
+    void removeAwake(int id) {
+        int slot = items[id].awakeSlot, last = awake.back();
+        awake[slot] = last;
+        items[last].awakeSlot = slot;
+        awake.pop_back();
+    }
+
+    // Inserta id en la lista por caducidad justo después de 'after' (-1 = al principio)
+    void linkAge(int id, int after) {
+        Item &it = items[id];
+        it.older = after;
+        it.newer = after != -1 ? items[after].newer : oldest;
+        if (it.older != -1) items[it.older].newer = id; else oldest = id;
+        if (it.newer != -1) items[it.newer].older = id; else newest = id;
+    }
+
+    void unlinkAge(int id) {
+        Item &it = items[id];
+        if (it.older != -1) items[it.older].newer = it.newer; else oldest = it.newer;
+        if (it.newer != -1) items[it.newer].older = it.older; else newest = it.older;
+    }
+
+    void release(int id) {
+        Item &it = items[id];
+        if (it.state == ITEM_AWAKE) removeAwake(id);
+        unlink(id);
+        unlinkAge(id);
+        it.state = ITEM_FREE;
+        freeIds.push_back(id);
+    }
+
+    // Se para: si hay cerca un montón del mismo bloque con sitio, se suma a él; si no, se duerme
+    bool settle(int id) {
+        Item &it = items[id];
+        const float cx = it.x + it.w * 0.5f, cy = it.y + it.h * 0.5f;
+        int into = -1;
+        forEachIn(cx - MERGE_RADIUS, cy - MERGE_RADIUS, cx + MERGE_RADIUS, cy + MERGE_RADIUS, [&](int o){
+            const Item &other = items[o];
+            if (into != -1 || o == id || other.block != it.block || other.count + it.count > MAX_COUNT) return;
+            if (std::hypot(other.x + other.w * 0.5f - cx, other.y + other.h * 0.5f - cy) <= MERGE_RADIUS) into = o;
+        });
+        if (into != -1) {
+            Item &other = items[into];
+            other.count = (std::uint16_t)(other.count + it.count);
+            if (it.expires > other.expires) {
+                // hereda la caducidad del que se suma y, con ella, su sitio en la lista
+                other.expires = it.expires;
+                unlinkAge(into);
+                linkAge(into, id);
+            }
+            release(id);
+            return true;
+        }
+        removeAwake(id);
+        it.state = ITEM_ASLEEP;
+        it.vx = it.vy = 0.0f;
+        it.prevX = it.x; it.prevY = it.y;
+        return true;
+    }
+
+    // take(bloque, cantidad) del objeto id; si se lo queda entero, se apunta para soltarlo
+    template <class F>
+    int takeFrom(int id, F &take) {
+        Item &it = items[id];
+        int n = std::min((int)it.count, take(it.block, (int)it.count));
+        if (n <= 0) return 0;
+        it.count = (std::uint16_t)(it.count - n);
+        if (it.count == 0) pendingRelease.push_back(id);
+        return n;
+    }
+
+    std::vector<Item> items;
+    std::vector<int> heads;          // primer objeto de cada cubo de la rejilla (-1 = vacío)
+    std::vector<int> freeIds, awake;
+    std::vector<int> pendingRelease; // recogidos en collect, se sueltan al acabar de recorrer
+    int oldest = -1, newest = -1;    // extremos de la lista por caducidad
+    float now = 0.0f;
+};
@@ -0,0 +1,168 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Sistema de trabajos fork/join con robo de trabajo para repartir un frame entre los núcleos.
+// Cada hilo tiene su cola: parallelFor parte el rango por la mitad hasta 'grain' elementos, deja las
+// mitades en la cola del hilo que las parte (que las vuelve a coger por detrás, de la más pequeña a la
+// más grande) y los hilos sin trabajo roban por delante de las colas de los demás, así que se llevan
+// los trozos grandes. El hilo que llama también trabaja y no vuelve hasta que se ha hecho todo el rango.
+//
+// fn(begin, end) recibe subrangos sin solapes en cualquier orden y en cualquier hilo: para que el
+// resultado no dependa del número de hilos, cada índice escribe solo lo suyo (su enemigo, su chunk...)
+// y lo que se comparte (el mundo, los pools de partículas) se junta después en serie y en orden.
+//
+// Solo un hilo de fuera (el principal) puede llamar a parallelFor a la vez; dentro de un trabajo
+// se puede volver a llamar. Con threads == 1 no se crea ningún hilo y todo va en línea.
+class JobSystem {
+public:
+    // threads: hilos en total, contando el que llama
+    explicit JobSystem(int threads) {
+        int n = std::max(1, threads);
+        for (int i = 0; i < n; ++i) queues.emplace_back(new Queue);
+        for (int i = 1; i < n; ++i) workers.emplace_back(&JobSystem::run, this, i);
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lk(sleepMutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (auto &t : workers) t.join();
+    }
+
+    int threadCount() const { return (int)queues.size(); }
+
+    template <class F>
+    void parallelFor(int begin, int end, int grain, F &&fn) {
+        if (end <= begin) return;
+        grain = std::max(1, grain);
+        if (queues.size() == 1 || end - begin <= grain) { fn(begin, end); return; }
+        using Fn = typename std::remove_reference<F>::type;
+        std::atomic<int> pending{1};
+        Task root{&invoke<Fn>, (void *)&fn, begin, end, grain, &pending};
+        int self = slot();
+        execute(root, self);
+        // mientras quedan trozos en otros hilos, ayudar (a este rango o a cualquier otro)
+        while (pending.load(std::memory_order_acquire) > 0)
+            if (!runOne(self)) std::this_thread::yield();
+    }
+
+private:
+    struct Task {
+        void (*call)(void *fn, int begin, int end);
+        void *fn;
+        int begin, end, grain;
+        std::atomic<int> *pending; // trozos del parallelFor aún sin terminar
+    };
+
+    struct Queue {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    template <class Fn>
+    static void invoke(void *fn, int begin, int end) { (*(Fn *)fn)(begin, end); }
+
+    // Cola del hilo actual: la suya en los trabajadores, la 0 en el hilo de fuera
+    int slot() const {
+        return current.owner == this ? current.index : 0;
+    }
+
+    void push(int self, const Task &t) {
+        {
+            std::lock_guard<std::mutex> lk(queues[self]->m);
+            queues[self]->tasks.push_back(t);
+        }
+        queued.fetch_add(1);
+        if (sleeping.load() > 0) {
+            std::lock_guard<std::mutex> lk(sleepMutex);
+            wake.notify_one();
+        }
+    }
+
+    // Parte lo que sobra de grain para que lo roben y hace el primer trozo
+    void execute(Task t, int self) {
+        while (t.end - t.begin > t.grain) {
+            int mid = t.begin + (t.end - t.begin) / 2;
+            t.pending->fetch_add(1, std::memory_order_relaxed);
+            push(self, Task{t.call, t.fn, mid, t.end, t.grain, t.pending});
+            t.end = mid;
+        }
+        t.call(t.fn, t.begin, t.end);
+        t.pending->fetch_sub(1, std::memory_order_acq_rel); // lo último que se toca de la tarea
+    }
+
+    // Lo más reciente de la cola propia o, si está vacía, lo más antiguo de otra
+    bool runOne(int self) {
+        Task t;
+        if (!pop(self, t) && !steal(self, t)) return false;
+        queued.fetch_sub(1);
+        execute(t, self);
+        return true;
+    }
+
+    bool pop(int self, Task &t) {
+        Queue &q = *queues[self];
+        std::lock_guard<std::mutex> lk(q.m);
+        if (q.tasks.empty()) return false;
+        t = q.tasks.back();
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(int self, Task &t) {
+        int n = (int)queues.size();
+        for (int k = 1; k < n; ++k) {
+            Queue &q = *queues[(self + k) % n];
+            std::lock_guard<std::mutex> lk(q.m);
+            if (q.tasks.empty()) continue;
+            t = q.tasks.front();
+            q.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+    void run(int index) {
+        current = Current{this, index};
+        for (;;) {
+            if (runOne(index)) continue;
+            std::unique_lock<std::mutex> lk(sleepMutex);
+            sleeping.fetch_add(1);
+            wake.wait(lk, [&]{ return quit || queued.load() > 0; });
+            sleeping.fetch_sub(1);
+            if (quit) break;
+        }
+    }
+
+    struct Current {
+        const JobSystem *owner;
+        int index;
+    };
+    static thread_local Current current;
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<int> queued{0}, sleeping{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool quit = false;
+};
+
+inline thread_local JobSystem::Current JobSystem::current{nullptr, 0};
+
+// parallelFor si hay sistema de trabajos; si no, todo el rango en el hilo actual
+template <class F>
+void parallel_for(JobSystem *jobs, int begin, int end, int grain, F &&fn) {
+    if (jobs) jobs->parallelFor(begin, end, grain, fn);
+    else if (begin < end) fn(begin, end);
+}
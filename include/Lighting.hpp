@@ -0,0 +1,197 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "JobSystem.hpp"
+#include "World.hpp"
+
+// Propagación de luz por tiles con BFS, en dos canales:
+// - cielo: nivel 15 en los tiles transparentes con el cielo encima; hacia abajo por el aire no se pierde
+// - bloques: lo que emite cada bloque (BLOCKS[b].light, p. ej. la lava)
+// Al pasar a un vecino la luz baja la opacidad del vecino, así que también entra unos tiles en el terreno.
+//
+// No se recalcula nada entero: World apunta los tiles cuya luz puede cambiar (lightEdits) y las columnas
+// recién cargadas (unlitColumns), y update() lo procesa todo de una vez, normalmente una vez por frame.
+// Los cambios de un mismo lote (p. ej. los 25 bloques de una explosión) comparten una sola pasada de
+// borrado y una de relleno.
+// Con un JobSystem, las fuentes de las columnas recién cargadas se siembran en paralelo (una columna por
+// trabajo); el relleno BFS sigue en serie. El resultado es el mismo con cualquier número de hilos.
+class LightEngine {
+public:
+    enum Channel { SKY = 0, BLOCK = 1 };
+
+    // Procesa el trabajo pendiente del mundo; devuelve cuántos tiles cambiaron de luz
+    std::size_t update(World &w, JobSystem *jobs = nullptr) {
+        changed = 0;
+        newColumns.clear();
+        for (int cx : w.unlitColumns)
+            if (w.isColumnLoaded(cx) && std::find(newColumns.begin(), newColumns.end(), cx) == newColumns.end()) newColumns.push_back(cx);
+        for (int c = SKY; c <= BLOCK; ++c) {
+            Channel ch = (Channel)c;
+            addQueue.clear();
+            seedColumns(w, ch, jobs);
+            if (!w.lightEdits.empty()) removeEdits(w, ch);
+            propagate(w, ch);
+        }
+        w.unlitColumns.clear();
+        w.lightEdits.clear();
+        return changed;
+    }
+
+    std::size_t lastChanged() const { return changed; }
+
+private:
+    struct Node { int x, y; std::uint8_t level; };
+
+    // vecinos: izquierda, derecha, arriba, abajo
+    static constexpr int DX[4] = { -1, 1, 0, 0 };
+    static constexpr int DY[4] = { 0, 0, -1, 1 };
+
+    static int get(const World &w, int x, int y, Channel c) {
+        std::uint8_t l = w.light(x, y);
+        return c == SKY ? sky_light(l) : block_light(l);
+    }
+
+    static void store(World &w, int x, int y, Channel c, int v) {
+        std::uint8_t l = w.light(x, y);
+        l = c == SKY ? (std::uint8_t)((v << 4) | (l & 15)) : (std::uint8_t)((l & 0xF0) | v);
+        w.setLight(x, y, l);
+    }
+
+    void set(World &w, int x, int y, Channel c, int v) {
+        store(w, x, y, c, v);
+        ++changed;
+    }
+
+    static int opacity(const World &w, int x, int y) { return BLOCKS[w.get(x, y)].opacity; }
+
+    // Nivel que llega a (x, y) desde un vecino con nivel 'from' en la dirección d
+    static int passed(const World &w, int x, int y, Channel c, int from, int d) {
+        int op = opacity(w, x, y);
+        if (c == SKY && d == 3 && from == LIGHT_MAX && op == 1) return LIGHT_MAX; // el cielo cae sin perder
+        return std::max(0, from - op);
+    }
+
+    // Nivel propio de un tile (sin contar vecinos): lo que emite o el cielo directo
+    static int source(const World &w, int x, int y, Channel c) {
+        if (c == BLOCK) return BLOCKS[w.get(x, y)].light;
+        if (opacity(w, x, y) != 1) return 0;
+        return (y == 0 || get(w, x, y - 1, SKY) == LIGHT_MAX) ? LIGHT_MAX : 0;
+    }
+
+    // Columnas nuevas: sus fuentes, y el borde de las columnas vecinas para que su luz entre.
+    // Sembrar una columna también marca para remallar los chunks de sus vecinas (World::setLight), así que
+    // en paralelo solo van a la vez columnas con el mismo cx % 3, que no comparten vecinas.
+    void seedColumns(World &w, Channel c, JobSystem *jobs) {
+        const int n = (int)newColumns.size();
+        if ((int)columnSeeds.size() < n) { columnSeeds.resize(n); columnChanged.resize(n); }
+        for (int pass = 0; pass < 3; ++pass) {
+            batch.clear();
+            for (int i = 0; i < n; ++i) if (((newColumns[i] % 3) + 3) % 3 == pass) batch.push_back(i);
+            parallel_for(jobs, 0, (int)batch.size(), 1, [&](int b0, int b1){
+                for (int b = b0; b < b1; ++b) {
+                    int i = batch[b];
+                    columnChanged[i] = seedSources(w, newColumns[i], c, columnSeeds[i]);
+                }
+            });
+        }
+        // en el orden de llegada de las columnas, como si se hubieran sembrado una tras otra
+        for (int i = 0; i < n; ++i) {
+            addQueue.insert(addQueue.end(), columnSeeds[i].begin(), columnSeeds[i].end());
+            changed += columnChanged[i];
+            int x0 = newColumns[i] * CHUNK_SIZE, h = w.height();
+            for (int x : {x0 - 1, x0 + CHUNK_SIZE}) {
+                if (!w.isColumnLoaded(x >> CHUNK_SHIFT)) continue;
+                for (int y = 0; y < h; ++y) {
+                    int v = get(w, x, y, c);
+                    if (v > 0) addQueue.push_back({x, y, (std::uint8_t)v});
+                }
+            }
+        }
+    }
+
+    // Fuentes de la columna cx: las enciende y las deja en seeds; devuelve cuántos tiles cambió
+    static std::size_t seedSources(World &w, int cx, Channel c, std::vector<Node> &seeds) {
+        seeds.clear();
+        int x0 = cx * CHUNK_SIZE, h = w.height();
+        for (int x = x0; x < x0 + CHUNK_SIZE; ++x) {
+            for (int y = 0; y < h; ++y) {
+                int v = source(w, x, y, c);
+                if (v > 0) { store(w, x, y, c, v); seeds.push_back({x, y, (std::uint8_t)v}); }
+            }
+        }
+        return seeds.size();
+    }
+
+    // Apaga la luz que dependía de los tiles editados; lo que queda iluminado en el borde
+    // de la zona apagada, y las nuevas fuentes de los tiles editados, se vuelven a propagar.
+    void removeEdits(World &w, Channel c) {
+        removeQueue.clear();
+        for (auto &e : w.lightEdits) {
+            if (!w.inBounds(e.first, e.second)) continue;
+            int v = get(w, e.first, e.second, c);
+            set(w, e.first, e.second, c, 0);
+            removeQueue.push_back({e.first, e.second, (std::uint8_t)v});
+        }
+        for (std::size_t i = 0; i < removeQueue.size(); ++i) {
+            Node n = removeQueue[i];
+            for (int d = 0; d < 4; ++d) {
+                int x = n.x + DX[d], y = n.y + DY[d];
+                if (!w.inBounds(x, y)) continue;
+                int v = get(w, x, y, c);
+                if (v == 0) continue;
+                bool fedByN = v < n.level || (c == SKY && d == 3 && v == LIGHT_MAX && n.level == LIGHT_MAX);
+                if (fedByN) { set(w, x, y, c, 0); removeQueue.push_back({x, y, (std::uint8_t)v}); }
+                else addQueue.push_back({x, y, (std::uint8_t)v});
+            }
+        }
+        // fuentes: los editados y todo lo apagado (un tile apagado puede tener cielo directo o emitir)
+        for (const Node &n : removeQueue) {
+            int v = source(w, n.x, n.y, c);
+            if (v > get(w, n.x, n.y, c)) { set(w, n.x, n.y, c, v); addQueue.push_back({n.x, n.y, (std::uint8_t)v}); }
+        }
+    }
+
+    // Relleno BFS desde addQueue
+    void propagate(World &w, Channel c) {
+        for (std::size_t i = 0; i < addQueue.size(); ++i) {
+            Node n = addQueue[i];
+            int level = get(w, n.x, n.y, c); // puede haber subido después de encolarlo
+            if (level <= 1) continue;
+            for (int d = 0; d < 4; ++d) {
+                int x = n.x + DX[d], y = n.y + DY[d];
+                if (!w.inBounds(x, y)) continue;
+                int v = passed(w, x, y, c, level, d);
+                if (v <= get(w, x, y, c)) continue;
+                set(w, x, y, c, v);
+                addQueue.push_back({x, y, (std::uint8_t)v});
+            }
+        }
+    }
+
+    std::vector<Node> addQueue, removeQueue; // se reutilizan entre llamadas
+    std::vector<int> newColumns, batch;
+    std::vector<std::vector<Node>> columnSeeds; // fuentes de cada columna nueva, una lista por trabajo
+    std::vector<std::size_t> columnChanged;
+    std::size_t changed = 0;
+};
+
+const float LIGHT_MIN_BRIGHTNESS = 0.06f; // las cuevas no quedan completamente negras
+
+// Brillo (0..1) con luz de cielo 'sky' y de bloques 'block' (0..1 cada una) y el cielo escalado por
+// 'daylight' (0..1, la hora del día). ChunkMesher hace la misma cuenta en su shader.
+inline float level_brightness(float sky, float block, float daylight) {
+    return LIGHT_MIN_BRIGHTNESS + (1.0f - LIGHT_MIN_BRIGHTNESS) * std::max(sky * daylight, block);
+}
+
+// Brillo (0..1) de un nivel de luz con el cielo escalado por 'daylight'
+inline float light_brightness(std::uint8_t l, float daylight) {
+    return level_brightness((float)sky_light(l) / LIGHT_MAX, (float)block_light(l) / LIGHT_MAX, daylight);
+}
+
+// Brillo en un tile cualquiera; fuera del mundo o sin cargar, la luz del cielo
+inline float tile_brightness(const World &w, int x, int y, float daylight) {
+    if (!w.inBounds(x, y)) return light_brightness((std::uint8_t)(LIGHT_MAX << 4), daylight);
+    return light_brightness(w.light(x, y), daylight);
+}
@@ -0,0 +1,234 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <vector>
+#include "InputLog.hpp"
+#include "RegionStore.hpp"
+#include "Simulation.hpp"
+
+// Protocolo del modo multijugador (GameServer.hpp / GameClient.hpp).
+// - TCP (fiable y en orden): saludo, columnas de chunks enteras al entrar en la zona de un cliente
+//   (RLE, como en disco), diferencias de chunks tras editar bloques y columnas que salen de la zona.
+// - UDP: la entrada del cliente en cada tick (con el último tick de snapshot que recibió) y las snapshots
+//   de entidades del servidor, codificadas como diferencia con esa snapshot confirmada. Si se pierde un
+//   datagrama no pasa nada: la siguiente snapshot sigue partiendo de la última que el cliente confirmó.
+// Cada mensaje empieza por un NetMsg; los enteros van en el orden de bytes de la máquina (BinWriter),
+// así que cliente y servidor tienen que ser de la misma arquitectura.
+
+const std::uint32_t NET_PROTOCOL = 2;
+const unsigned short NET_DEFAULT_PORT = 25600;
+const int NET_MAX_CLIENTS = 64;
+const int NET_VIEW_RADIUS = 3;             // columnas de chunks que recibe cada cliente a cada lado de la suya
+const float NET_ENTITY_RANGE = ACTIVE_RANGE; // px: entidades que entran en la snapshot de un cliente
+const int NET_HISTORY = 64;                // snapshots que recuerdan ambos lados para las diferencias
+const float NET_POS_SCALE = 8.0f;          // las posiciones viajan en 1/8 de píxel
+const std::uint16_t NET_ENEMY_ID = 256;    // id de entidad: cliente (0..255) o NET_ENEMY_ID + índice del enemigo
+const std::uint16_t NET_ITEM_ID = 0x8000;  // ...o NET_ITEM_ID + índice del objeto soltado (ItemPool)
+const std::uint8_t NET_KIND_ITEM = 0xFF;   // kind de los objetos soltados: hp es el bloque y flags la cantidad
+
+enum NetMsg : std::uint8_t { MSG_HELLO = 0, MSG_WELCOME, MSG_COLUMN, MSG_CHUNK_DELTA, MSG_COLUMN_DROP, MSG_INPUT, MSG_SNAPSHOT, NET_MSG_COUNT };
+static const char* const NET_MSG_NAMES[NET_MSG_COUNT] = { "hello", "welcome", "column", "chunk-delta", "column-drop", "input", "snapshot" };
+
+// Tráfico por tipo de mensaje. Cuenta solo los bytes de los mensajes (sin cabeceras IP/TCP/UDP).
+struct NetStats {
+    std::uint64_t sentBytes[NET_MSG_COUNT] = {}, sentCount[NET_MSG_COUNT] = {};
+    std::uint64_t recvBytes[NET_MSG_COUNT] = {}, recvCount[NET_MSG_COUNT] = {};
+
+    void sent(std::uint8_t type, std::size_t bytes) { if (type < NET_MSG_COUNT) { sentBytes[type] += bytes; ++sentCount[type]; } }
+    void received(std::uint8_t type, std::size_t bytes) { if (type < NET_MSG_COUNT) { recvBytes[type] += bytes; ++recvCount[type]; } }
+
+    void add(const NetStats &o) {
+        for (int i = 0; i < NET_MSG_COUNT; ++i) {
+            sentBytes[i] += o.sentBytes[i]; sentCount[i] += o.sentCount[i];
+            recvBytes[i] += o.recvBytes[i]; recvCount[i] += o.recvCount[i];
+        }
+    }
+
+    // Tabla con mensajes, kB y kB/s de cada tipo en 'seconds' segundos
+    void print(std::ostream &out, double seconds) const {
+        out << std::fixed << std::setprecision(1);
+        for (int i = 0; i < NET_MSG_COUNT; ++i) {
+            if (sentCount[i] == 0 && recvCount[i] == 0) continue;
+            out << "  " << std::left << std::setw(12) << NET_MSG_NAMES[i] << std::right
+                << " enviados " << std::setw(8) << sentCount[i] << " msg " << std::setw(9) << sentBytes[i] / 1024.0 << " kB "
+                << std::setw(7) << (seconds > 0.0 ? sentBytes[i] / 1024.0 / seconds : 0.0) << " kB/s"
+                << "   recibidos " << std::setw(8) << recvCount[i] << " msg " << std::setw(9) << recvBytes[i] / 1024.0 << " kB "
+                << std::setw(7) << (seconds > 0.0 ? recvBytes[i] / 1024.0 / seconds : 0.0) << " kB/s" << std::endl;
+        }
+        out << std::defaultfloat;
+    }
+};
+
+// Un jugador o un enemigo en una snapshot
+enum : std::uint8_t { NET_ALIVE = 1, NET_FACING_LEFT = 2, NET_FUSE = 4 };
+
+struct NetEntity {
+    std::uint16_t id;
+    std::uint8_t kind;  // 0 = jugador, 1 + Enemy::Type, NET_KIND_ITEM
+    std::uint8_t flags; // NET_ALIVE, NET_FACING_LEFT, NET_FUSE
+    std::int32_t x, y;  // en 1/NET_POS_SCALE px
+    std::uint8_t hp;
+
+    static NetEntity fromPlayer(std::uint16_t id, const Player &p) {
+        return NetEntity{id, 0, (std::uint8_t)(NET_ALIVE | (p.fx < 0 ? NET_FACING_LEFT : 0)),
+                         (std::int32_t)std::lround(p.px * NET_POS_SCALE), (std::int32_t)std::lround(p.py * NET_POS_SCALE), 0};
+    }
+
+    static NetEntity fromEnemy(int index, const Enemy &e) {
+        return NetEntity{(std::uint16_t)(NET_ENEMY_ID + index), (std::uint8_t)(1 + e.type),
+                         (std::uint8_t)((e.alive ? NET_ALIVE : 0) | (e.vx < 0.0f ? NET_FACING_LEFT : 0) | (e.fuseTimer > 0.0f ? NET_FUSE : 0)),
+                         (std::int32_t)std::lround(e.x * NET_POS_SCALE), (std::int32_t)std::lround(e.y * NET_POS_SCALE), (std::uint8_t)std::max(0, e.hp)};
+    }
+
+    static NetEntity fromItem(int index, const ItemPool::Item &it) {
+        return NetEntity{(std::uint16_t)(NET_ITEM_ID + index), NET_KIND_ITEM, (std::uint8_t)std::min<int>(it.count, 255),
+                         (std::int32_t)std::lround(it.x * NET_POS_SCALE), (std::int32_t)std::lround(it.y * NET_POS_SCALE), (std::uint8_t)it.block};
+    }
+
+    float px() const { return x / NET_POS_SCALE; }
+    float py() const { return y / NET_POS_SCALE; }
+};
+
+// Lo que solo necesita el propio jugador (HUD, barra de picar, espada)
+enum : std::uint8_t { NET_INVULN = 1, NET_SWING = 2, NET_BREAKING = 4 };
+
+struct NetSelf {
+    std::uint8_t health = 0, flags = 0, selected = 0, tool = 0;
+    std::int32_t breakX = -1, breakY = -1;
+    float breakProgress = 0.0f;
+    std::array<std::uint16_t, HOTBAR_SIZE> counts{};
+
+    static NetSelf from(const PlayerState &ps) {
+        NetSelf s;
+        s.health = (std::uint8_t)std::max(0, ps.playerHealth);
+        s.flags = (std::uint8_t)((ps.playerInvuln > 0.0f ? NET_INVULN : 0) | (ps.swingActive > 0.0f ? NET_SWING : 0) | (ps.breaking ? NET_BREAKING : 0));
+        s.selected = ps.p.selected; s.tool = (std::uint8_t)ps.p.selectedTool;
+        s.breakX = ps.breakX; s.breakY = ps.breakY; s.breakProgress = ps.breakProgress;
+        for (int i = 0; i < HOTBAR_SIZE; ++i) s.counts[i] = (std::uint16_t)ps.p.inv[HOTBAR[i]];
+        return s;
+    }
+
+    bool operator==(const NetSelf &o) const {
+        return health == o.health && flags == o.flags && selected == o.selected && tool == o.tool && breakX == o.breakX
+            && breakY == o.breakY && breakProgress == o.breakProgress && counts == o.counts;
+    }
+};
+
+// Campos de una entidad que cambian respecto a la snapshot base
+enum : std::uint8_t { ENT_KIND = 1, ENT_X = 2, ENT_Y = 4, ENT_HP = 8, ENT_FLAGS = 16, ENT_ALL = 31 };
+
+// cur como diferencia con base (las dos ordenadas por id; base vacía = snapshot completa):
+// las entidades nuevas o cambiadas con una máscara de campos, y después los ids que ya no están
+inline void write_entity_delta(BinWriter &w, const std::vector<NetEntity> &base, const std::vector<NetEntity> &cur) {
+    auto mask = [](const NetEntity *b, const NetEntity &c) -> std::uint8_t {
+        if (!b) return ENT_ALL;
+        return (std::uint8_t)((b->kind != c.kind ? ENT_KIND : 0) | (b->x != c.x ? ENT_X : 0) | (b->y != c.y ? ENT_Y : 0)
+                              | (b->hp != c.hp ? ENT_HP : 0) | (b->flags != c.flags ? ENT_FLAGS : 0));
+    };
+    // dos pasadas: contar y escribir, recorriendo base y cur a la vez
+    for (int pass = 0; pass < 2; ++pass) {
+        std::uint16_t changed = 0;
+        std::size_t bi = 0;
+        for (const NetEntity &c : cur) {
+            while (bi < base.size() && base[bi].id < c.id) ++bi;
+            const NetEntity *b = (bi < base.size() && base[bi].id == c.id) ? &base[bi] : nullptr;
+            std::uint8_t m = mask(b, c);
+            if (m == 0) continue;
+            ++changed;
+            if (pass == 0) continue;
+            w.put(c.id); w.put(m);
+            if (m & ENT_KIND) w.put(c.kind);
+            if (m & ENT_X) w.put(c.x);
+            if (m & ENT_Y) w.put(c.y);
+            if (m & ENT_HP) w.put(c.hp);
+            if (m & ENT_FLAGS) w.put(c.flags);
+        }
+        if (pass == 0) w.put(changed);
+    }
+    std::uint16_t removed = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        std::size_t ci = 0;
+        for (const NetEntity &b : base) {
+            while (ci < cur.size() && cur[ci].id < b.id) ++ci;
+            if (ci < cur.size() && cur[ci].id == b.id) continue;
+            if (pass == 0) ++removed; else w.put(b.id);
+        }
+        if (pass == 0) w.put(removed);
+    }
+}
+
+// Reconstruye en out la snapshot que write_entity_delta codificó a partir de base
+inline bool read_entity_delta(BinReader &r, const std::vector<NetEntity> &base, std::vector<NetEntity> &out) {
+    out.clear();
+    std::uint16_t changed = 0, removed = 0;
+    if (!r.get(changed)) return false;
+    std::size_t bi = 0;
+    for (std::uint16_t k = 0; k < changed; ++k) {
+        std::uint16_t id = 0; std::uint8_t m = 0;
+        if (!r.get(id) || !r.get(m)) return false;
+        while (bi < base.size() && base[bi].id < id) out.push_back(base[bi++]);
+        NetEntity e{id, 0, 0, 0, 0, 0};
+        if (bi < base.size() && base[bi].id == id) e = base[bi++];
+        else if (m != ENT_ALL) return false; // cambia algo que no tenemos: la base no es la que creía el servidor
+        if (m & ENT_KIND) r.get(e.kind);
+        if (m & ENT_X) r.get(e.x);
+        if (m & ENT_Y) r.get(e.y);
+        if (m & ENT_HP) r.get(e.hp);
+        if (m & ENT_FLAGS) r.get(e.flags);
+        out.push_back(e);
+    }
+    while (bi < base.size()) out.push_back(base[bi++]);
+    if (!r.get(removed)) return false;
+    for (std::uint16_t k = 0; k < removed; ++k) {
+        std::uint16_t id = 0;
+        if (!r.get(id)) return false;
+        auto it = std::lower_bound(out.begin(), out.end(), id, [](const NetEntity &e, std::uint16_t v){ return e.id < v; });
+        if (it != out.end() && it->id == id) out.erase(it);
+    }
+    return r.good();
+}
+
+// Diferencia entre dos versiones de un chunk: tramos (u16 tiles iguales que saltar, u8 cuántos cambian,
+// los bloques nuevos). Una edición suelta ocupa 4 bytes; una explosión de creeper, unos 40.
+inline void encode_chunk_delta(const BlockId *before, const BlockId *after, std::vector<unsigned char> &out) {
+    out.clear();
+    int pos = 0;
+    for (int i = 0; i < CHUNK_AREA;) {
+        if (before[i] == after[i]) { ++i; continue; }
+        int run = 1;
+        while (i + run < CHUNK_AREA && run < 255 && before[i + run] != after[i + run]) ++run;
+        std::uint16_t skip = (std::uint16_t)(i - pos);
+        out.push_back((unsigned char)(skip & 0xFF));
+        out.push_back((unsigned char)(skip >> 8));
+        out.push_back((unsigned char)run);
+        for (int k = 0; k < run; ++k) out.push_back(after[i + k]);
+        i += run;
+        pos = i;
+    }
+}
+
+// f(índice en el chunk, bloque nuevo) por cada tile que cambia; false si los datos están mal
+template <class F>
+bool decode_chunk_delta(const unsigned char *p, std::size_t n, F &&f) {
+    int pos = 0;
+    std::size_t k = 0;
+    while (k < n) {
+        if (n - k < 3) return false;
+        int skip = p[k] | (p[k + 1] << 8), run = p[k + 2];
+        k += 3;
+        pos += skip;
+        if (run == 0 || n - k < (std::size_t)run || pos + run > CHUNK_AREA) return false;
+        for (int i = 0; i < run; ++i) {
+            if (p[k + i] >= BLOCK_COUNT) return false;
+            f(pos + i, (BlockId)p[k + i]);
+        }
+        k += run;
+        pos += run;
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "JobSystem.hpp"
+
+// Conjunto de partículas de capacidad fija guardado como estructura de arrays
+// (x, y, vx, vy, vida, tamaño, color). Las partículas muertas se quitan intercambiándolas
+// con la última, así que el orden no se conserva, y toda la capa se dibuja con un solo VertexArray.
+class ParticlePool {
+public:
+    explicit ParticlePool(std::size_t capacity) : cap(capacity) {
+        x.resize(cap); y.resize(cap); vx.resize(cap); vy.resize(cap);
+        life.resize(cap); size.resize(cap); prevX.resize(cap); prevY.resize(cap);
+        color.resize(cap);
+    }
+
+    std::size_t count() const { return n; }
+    std::size_t capacity() const { return cap; }
+    void clear() { n = 0; }
+
+    // Devuelve false (y descarta la partícula) si el pool está lleno
+    bool spawn(float px, float py, float pvx, float pvy, float plife, float psize, sf::Color pcol) {
+        if (n == cap) return false;
+        x[n] = px; y[n] = py; vx[n] = pvx; vy[n] = pvy;
+        life[n] = plife; size[n] = psize; color[n] = pcol;
+        prevX[n] = px; prevY[n] = py;
+        ++n;
+        return true;
+    }
+
+    // Guarda la posición actual como la del paso anterior (para interpolar al dibujar)
+    void savePrevious() {
+        std::copy(x.begin(), x.begin() + n, prevX.begin());
+        std::copy(y.begin(), y.begin() + n, prevY.begin());
+    }
+
+    static const int JOB_GRAIN = 4096; // partículas por trabajo al integrar en paralelo
+
+    // Integra dt segundos con gravedad 'gravity' (px/s^2) y elimina las que agotan su vida o pasan de killBelowY.
+    // Con jobs la integración se reparte por tramos; la compactación es en serie, así que el orden no cambia.
+    void update(float dt, float gravity, float killBelowY, JobSystem *jobs = nullptr) {
+        float *px = x.data(), *py = y.data(), *pvx = vx.data(), *pvy = vy.data(), *pl = life.data();
+        parallel_for(jobs, 0, (int)n, JOB_GRAIN, [=](int i0, int i1){
+            for (int i = i0; i < i1; ++i) {
+                px[i] += pvx[i] * dt;
+                py[i] += pvy[i] * dt;
+                pvy[i] += gravity * dt;
+                pl[i] -= dt;
+            }
+        });
+        for (std::size_t i = 0; i < n;) {
+            if (pl[i] <= 0.0f || py[i] > killBelowY) removeAt(i); else ++i;
+        }
+    }
+
+    // Añade un quad por partícula, de size x (size*aspect) píxeles, interpolando con lerp (0..1).
+    // Con fade, la opacidad baja durante el último segundo de vida.
+    void appendQuads(sf::VertexArray &va, float lerp, float aspect, bool fade) const {
+        for (std::size_t i = 0; i < n; ++i) {
+            float x0 = prevX[i] + (x[i] - prevX[i]) * lerp;
+            float y0 = prevY[i] + (y[i] - prevY[i]) * lerp;
+            float x1 = x0 + size[i], y1 = y0 + size[i] * aspect;
+            sf::Color c = color[i];
+            if (fade) c.a = (sf::Uint8)(c.a * std::min(1.0f, std::max(0.0f, life[i])));
+            va.append(sf::Vertex(sf::Vector2f(x0, y0), c));
+            va.append(sf::Vertex(sf::Vector2f(x1, y0), c));
+            va.append(sf::Vertex(sf::Vector2f(x1, y1), c));
+            va.append(sf::Vertex(sf::Vector2f(x0, y1), c));
+        }
+    }
+
+private:
+    void removeAt(std::size_t i) {
+        std::size_t last = --n;
+        x[i] = x[last]; y[i] = y[last]; vx[i] = vx[last]; vy[i] = vy[last];
+        life[i] = life[last]; size[i] = size[last]; color[i] = color[last];
+        prevX[i] = prevX[last]; prevY[i] = prevY[last];
+    }
+
+    std::size_t cap;
+    std::size_t n = 0;
+    std::vector<float> x, y, vx, vy, life, size, prevX, prevY;
+    std::vector<sf::Color> color;
+};
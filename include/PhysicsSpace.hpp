@@ -1,3 +1,6 @@
+#pragma once
+#include <chipmunk/chipmunk.h>
+
 
 class PhysicsSpace {
 public:
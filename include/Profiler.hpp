@@ -0,0 +1,156 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Perfilador de frames: cada fase (eventos, simulación y sus fases, render de tiles, entidades, HUD,
+// display...) se mide con lap() como en Simulation y se guarda de dos formas:
+// - un evento (fase, inicio, duración) en un buffer circular de tamaño fijo, para exportarlo en formato
+//   Chrome trace (chrome://tracing o ui.perfetto.dev) y ver de dónde salió un pico concreto
+// - el total de la fase en cada frame, en un historial de HISTORY frames para medias y p99
+// Solo escribe el hilo principal; el buffer no usa locks (un índice atómico) y no reserva memoria al medir.
+class FrameProfiler {
+public:
+    static constexpr int MAX_SCOPES = 32;
+    static constexpr int HISTORY = 240;                 // frames (4 s a 60 FPS)
+    static constexpr std::size_t EVENT_CAPACITY = 1 << 16; // potencia de 2
+    static constexpr int FRAME = 0;                     // fase de todo el frame, de beginFrame a endFrame
+
+    using Clock = std::chrono::steady_clock;
+
+    FrameProfiler() : epoch(Clock::now()), events(EVENT_CAPACITY) { scope("frame"); }
+
+    // Registra una fase y devuelve su id (los nombres han de vivir todo el programa)
+    int scope(const char *name) {
+        if (scopeCount == MAX_SCOPES) return FRAME;
+        names[scopeCount] = name;
+        return scopeCount++;
+    }
+
+    Clock::time_point now() const { return Clock::now(); }
+
+    // Apunta la fase id desde t0 hasta ahora y deja t0 en ahora (para encadenar fases)
+    void lap(int id, Clock::time_point &t0) {
+        Clock::time_point t1 = Clock::now();
+        record(id, t0, t1);
+        t0 = t1;
+    }
+
+    void record(int id, Clock::time_point t0, Clock::time_point t1) {
+        std::uint64_t start = ns(t0), dur = ns(t1) - start;
+        std::uint64_t h = head.load(std::memory_order_relaxed);
+        events[h & (EVENT_CAPACITY - 1)] = Event{start, (std::uint32_t)std::min<std::uint64_t>(dur, UINT32_MAX), (std::uint16_t)id};
+        head.store(h + 1, std::memory_order_release);
+        frameNs[id] += dur;
+    }
+
+    void beginFrame() { frameStart = Clock::now(); }
+
+    // Cierra el frame: apunta su duración y pasa los totales de cada fase al historial
+    void endFrame() {
+        record(FRAME, frameStart, Clock::now());
+        int slot = (int)(frames % HISTORY);
+        for (int i = 0; i < scopeCount; ++i) { history[i][slot] = frameNs[i] / 1e6f; frameNs[i] = 0; }
+        ++frames;
+    }
+
+    int scopeCountRegistered() const { return scopeCount; }
+    const char *name(int id) const { return names[id]; }
+    int historySize() const { return (int)std::min<std::uint64_t>(frames, HISTORY); }
+    // Valor en ms de la fase id hace 'ago' frames (0 = el último terminado)
+    float frameMs(int id, int ago) const { return history[id][(int)((frames - 1 - ago) % HISTORY)]; }
+
+    float averageMs(int id) const {
+        int n = historySize();
+        if (n == 0) return 0.0f;
+        float sum = 0.0f;
+        for (int i = 0; i < n; ++i) sum += history[id][i];
+        return sum / n;
+    }
+
+    float percentileMs(int id, float pct) const {
+        int n = historySize();
+        if (n == 0) return 0.0f;
+        std::array<float, HISTORY> v;
+        std::copy(history[id].begin(), history[id].begin() + n, v.begin());
+        int k = std::min(n - 1, (int)(pct / 100.0f * n));
+        std::nth_element(v.begin(), v.begin() + k, v.begin() + n);
+        return v[k];
+    }
+
+    // Vuelca los eventos del buffer (los últimos EVENT_CAPACITY) en formato Chrome trace
+    bool writeTrace(const std::string &path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        std::uint64_t h = head.load(std::memory_order_acquire);
+        std::uint64_t first = h > EVENT_CAPACITY ? h - EVENT_CAPACITY : 0;
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        char line[160];
+        for (std::uint64_t i = first; i < h; ++i) {
+            const Event &e = events[i & (EVENT_CAPACITY - 1)];
+            std::snprintf(line, sizeof(line), "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.3f,\"dur\":%.3f}\n",
+                          i == first ? "" : ",", names[e.scope], e.startNs / 1e3, e.durNs / 1e3);
+            out << line;
+        }
+        out << "]}\n";
+        return (bool)out;
+    }
+
+    // Panel con media y p99 de cada fase y la gráfica de duración de los últimos frames
+    void drawOverlay(sf::RenderTarget &target, const sf::Font &font, float x, float y) const {
+        const float lineH = 15.0f, graphW = (float)HISTORY, graphH = 60.0f;
+        const float budgetMs = 1000.0f / 60.0f, scaleMs = 2.0f * budgetMs; // la gráfica llega a 33 ms
+        const float panelW = std::max(graphW, 300.0f) + 16.0f, panelH = scopeCount * lineH + graphH + 24.0f;
+        sf::RectangleShape panel(sf::Vector2f(panelW, panelH));
+        panel.setPosition(x, y);
+        panel.setFillColor(sf::Color(0, 0, 0, 180));
+        target.draw(panel);
+        char buf[96];
+        for (int i = 0; i < scopeCount; ++i) {
+            std::snprintf(buf, sizeof(buf), "%-10s %7.2f ms  p99 %7.2f ms", names[i], averageMs(i), percentileMs(i, 99.0f));
+            sf::Text t(buf, font, 12);
+            t.setFillColor(i == FRAME ? sf::Color::Yellow : sf::Color::White);
+            t.setPosition(x + 8.0f, y + 6.0f + i * lineH);
+            target.draw(t);
+        }
+        // barras de duración del frame (la más reciente a la derecha) y línea de 16,7 ms
+        float gx = x + 8.0f, gy = y + 12.0f + scopeCount * lineH + graphH;
+        sf::VertexArray bars(sf::Lines);
+        for (int ago = 0, n = historySize(); ago < n; ++ago) {
+            float ms = frameMs(FRAME, ago);
+            float bx = gx + graphW - 1 - ago, bh = std::min(ms / scaleMs, 1.0f) * graphH;
+            sf::Color c = ms > 2.0f * budgetMs ? sf::Color::Red : ms > budgetMs ? sf::Color::Yellow : sf::Color::Green;
+            bars.append(sf::Vertex(sf::Vector2f(bx, gy), c));
+            bars.append(sf::Vertex(sf::Vector2f(bx, gy - bh), c));
+        }
+        float by = gy - budgetMs / scaleMs * graphH;
+        bars.append(sf::Vertex(sf::Vector2f(gx, by), sf::Color(255, 255, 255, 120)));
+        bars.append(sf::Vertex(sf::Vector2f(gx + graphW, by), sf::Color(255, 255, 255, 120)));
+        target.draw(bars);
+    }
+
+private:
+    struct Event {
+        std::uint64_t startNs;
+        std::uint32_t durNs;
+        std::uint16_t scope;
+    };
+
+    std::uint64_t ns(Clock::time_point t) const { return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t - epoch).count(); }
+
+    Clock::time_point epoch, frameStart;
+    std::vector<Event> events;
+    std::atomic<std::uint64_t> head{0};
+    const char *names[MAX_SCOPES] = {};
+    int scopeCount = 0;
+    std::uint64_t frameNs[MAX_SCOPES] = {};
+    std::array<std::array<float, HISTORY>, MAX_SCOPES> history{};
+    std::uint64_t frames = 0;
+};
@@ -0,0 +1,406 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "World.hpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Formato de guardado:
+//  <dir>/level.dat       cabecera (semilla, altura) + estado del jugador y enemigos
+//  <dir>/r.<rx>.bin      región de REGION_COLUMNS columnas de chunks:
+//                        cabecera, tabla de offsets (una entrada por chunk) y datos de cada chunk:
+//                        los bloques en RLE y detrás los tiles de fluido que no están llenos
+// Solo se guardan los chunks modificados (bit CHUNK_DIRTY_SAVE); el resto se regenera desde la semilla.
+// Las regiones se leen con memoria mapeada y cada chunk se decodifica al cargarse su columna.
+const int REGION_SHIFT = 4;
+const int REGION_COLUMNS = 1 << REGION_SHIFT;
+const std::uint32_t SAVE_VERSION = 1;
+
+// Fichero de solo lectura proyectado en memoria
+class MappedFile {
+public:
+    MappedFile() {}
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    ~MappedFile() {
+        close();
+    }
+
+    bool open(const std::string &path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER sz;
+        if (!GetFileSizeEx(file, &sz) || sz.QuadPart == 0) { close(); return false; }
+        len = (std::size_t)sz.QuadPart;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) { close(); return false; }
+        ptr = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!ptr) { close(); return false; }
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) { close(); return false; }
+        len = (std::size_t)st.st_size;
+        void *p = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) { close(); return false; }
+        ptr = (const unsigned char *)p;
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (ptr) UnmapViewOfFile(ptr);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr; file = INVALID_HANDLE_VALUE;
+#else
+        if (ptr) munmap((void *)ptr, len);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        ptr = nullptr; len = 0;
+    }
+
+    const unsigned char *data() const { return ptr; }
+    std::size_t size() const { return len; }
+
+private:
+    const unsigned char *ptr = nullptr;
+    std::size_t len = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+// Serialización binaria mínima para tipos trivialmente copiables y cadenas
+class BinWriter {
+public:
+    template <class T>
+    void put(const T &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "BinWriter::put needs a trivially copyable type");
+        const char *p = (const char *)&v;
+        buf.insert(buf.end(), p, p + sizeof(T));
+    }
+
+    void putString(const std::string &s) {
+        put((std::uint32_t)s.size());
+        buf.insert(buf.end(), s.begin(), s.end());
+    }
+
+    const std::vector<char> &data() const { return buf; }
+
+private:
+    std::vector<char> buf;
+};
+
+class BinReader {
+public:
+    BinReader(const char *data, std::size_t size) : p(data), end(data + size) {}
+
+    template <class T>
+    bool get(T &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "BinReader::get needs a trivially copyable type");
+        if ((std::size_t)(end - p) < sizeof(T)) { ok = false; return false; }
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+
+    bool getString(std::string &s) {
+        std::uint32_t n = 0;
+        if (!get(n) || (std::size_t)(end - p) < n) { ok = false; return false; }
+        s.assign(p, n);
+        p += n;
+        return true;
+    }
+
+    bool good() const { return ok; }
+
+private:
+    const char *p;
+    const char *end;
+    bool ok = true;
+};
+
+class RegionStore {
+public:
+    explicit RegionStore(const std::string &dir) : dir(dir) {}
+
+    const std::string &directory() const { return dir; }
+
+    // Lee level.dat. Devuelve false si no existe o no es válido; si es válido deja
+    // la semilla, la altura y el bloque de estado de la partida en los parámetros.
+    bool readLevel(std::uint32_t &seed, int &height, std::vector<char> &state) {
+        MappedFile f;
+        if (!f.open(dir + "/level.dat")) return false;
+        BinReader r((const char *)f.data(), f.size());
+        char magic[4]; std::uint32_t version = 0, s = 0; std::int32_t h = 0;
+        if (!r.get(magic) || std::memcmp(magic, "MC2L", 4) != 0 || !r.get(version) || version != SAVE_VERSION) return false;
+        if (!r.get(s) || !r.get(h)) return false;
+        seed = s; height = h; chunksY = (h + CHUNK_MASK) >> CHUNK_SHIFT;
+        std::size_t header = 4 + sizeof(version) + sizeof(s) + sizeof(h);
+        state.assign((const char *)f.data() + header, (const char *)f.data() + f.size());
+        return true;
+    }
+
+    // Escribe level.dat de forma atómica (fichero temporal + renombrado)
+    bool writeLevel(std::uint32_t seed, int height, const std::vector<char> &state) {
+        std::filesystem::create_directories(dir);
+        chunksY = (height + CHUNK_MASK) >> CHUNK_SHIFT;
+        std::string tmp = dir + "/level.dat.tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            std::uint32_t version = SAVE_VERSION; std::int32_t h = height;
+            out.write("MC2L", 4);
+            out.write((const char *)&version, sizeof(version));
+            out.write((const char *)&seed, sizeof(seed));
+            out.write((const char *)&h, sizeof(h));
+            out.write(state.data(), (std::streamsize)state.size());
+            if (!out) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, dir + "/level.dat", ec);
+        return !ec;
+    }
+
+    // Sustituye los chunks de la columna cx por los guardados (si los hay). Llamar al cargarla.
+    void applyColumn(World &world, int cx) {
+        chunksY = world.chunksY();
+        Region *r = region(cx >> REGION_SHIFT);
+        if (!r || !r->map.data()) return;
+        for (int cy = 0; cy < chunksY; ++cy) {
+            const Entry &e = r->table[slot(cx, cy)];
+            if (e.size == 0 || (std::size_t)e.offset + e.size > r->map.size()) continue;
+            const unsigned char *p = r->map.data() + e.offset;
+            std::size_t blocks = rleSize(p, e.size);
+            std::unique_ptr<Chunk> c(new Chunk(cx, cy, (BlockId)AIR));
+            if (blocks == 0 || !decode(p, blocks, *c)) continue;
+            Chunk *raw = c.get();
+            world.setChunk(cx, cy, std::move(c));
+            decodeFluid(world, *raw, p + blocks, e.size - blocks);
+            raw->dirty = CHUNK_DIRTY_ALL & ~CHUNK_DIRTY_SAVE;
+        }
+    }
+
+    // Escribe los chunks modificados de la columna cx (antes de descargarla)
+    void saveColumn(World &world, int cx) {
+        std::vector<Chunk *> dirty;
+        for (int cy = 0; cy < world.chunksY(); ++cy) {
+            Chunk *c = world.chunkAt(cx, cy);
+            if (c && (c->dirty & CHUNK_DIRTY_SAVE)) dirty.push_back(c);
+        }
+        if (!dirty.empty()) writeChunks(world, cx >> REGION_SHIFT, dirty);
+    }
+
+    // Escribe todos los chunks modificados del mundo; devuelve cuántos
+    int saveDirty(World &world) {
+        chunksY = world.chunksY();
+        std::unordered_map<int, std::vector<Chunk *>> byRegion;
+        world.forEachChunk([&](Chunk &c){ if (c.dirty & CHUNK_DIRTY_SAVE) byRegion[c.cx >> REGION_SHIFT].push_back(&c); });
+        int n = 0;
+        for (auto &kv : byRegion) { writeChunks(world, kv.first, kv.second); n += (int)kv.second.size(); }
+        return n;
+    }
+
+    // RLE: pares (longitud 1..255, bloque). También lo usa la red para mandar chunks enteros.
+    static void encode(const Chunk &c, std::vector<unsigned char> &out) {
+        out.clear();
+        for (int i = 0; i < CHUNK_AREA;) {
+            BlockId b = c.blocks[i];
+            int run = 1;
+            while (i + run < CHUNK_AREA && run < 255 && c.blocks[i + run] == b) ++run;
+            out.push_back((unsigned char)run);
+            out.push_back(b);
+            i += run;
+        }
+    }
+
+    static bool decode(const unsigned char *p, std::size_t n, Chunk &c) {
+        int i = 0;
+        for (std::size_t k = 0; k + 1 < n; k += 2) {
+            int run = p[k];
+            if (i + run > CHUNK_AREA) return false;
+            if (p[k + 1] >= BLOCK_COUNT) return false;
+            std::memset(c.blocks.data() + i, p[k + 1], run);
+            i += run;
+        }
+        return i == CHUNK_AREA;
+    }
+
+private:
+    // Bytes del RLE de bloques al principio de p (0 si no llega a cubrir el chunk)
+    static std::size_t rleSize(const unsigned char *p, std::size_t n) {
+        int i = 0;
+        for (std::size_t k = 0; k + 1 < n; k += 2) {
+            i += p[k];
+            if (i >= CHUNK_AREA) return k + 2;
+        }
+        return 0;
+    }
+
+    // Fluidos que no están llenos: (índice del tile en 2 bytes, FLUID_MAX - nivel). Lo generado
+    // o sin entrada está lleno, así que casi siempre no se escribe nada.
+    static void encodeFluid(const World &world, const Chunk &c, std::vector<unsigned char> &out) {
+        for (int i = 0; i < CHUNK_AREA; ++i) {
+            if (!BLOCKS[c.blocks[i]].flow) continue;
+            int missing = FLUID_MAX - world.fluidLevel(c.cx * CHUNK_SIZE + (i & CHUNK_MASK), c.cy * CHUNK_SIZE + (i >> CHUNK_SHIFT));
+            if (missing == 0) continue;
+            out.push_back((unsigned char)(i & 0xFF));
+            out.push_back((unsigned char)(i >> 8));
+            out.push_back((unsigned char)missing);
+        }
+    }
+
+    // Restaura los niveles y despierta esos tiles: al guardar podían estar a mitad de fluir
+    static void decodeFluid(World &world, const Chunk &c, const unsigned char *p, std::size_t n) {
+        for (std::size_t k = 0; k + 2 < n; k += 3) {
+            int i = p[k] | p[k + 1] << 8, missing = p[k + 2];
+            if (i >= CHUNK_AREA || !BLOCKS[c.blocks[i]].flow || missing >= FLUID_MAX) continue;
+            int x = c.cx * CHUNK_SIZE + (i & CHUNK_MASK), y = c.cy * CHUNK_SIZE + (i >> CHUNK_SHIFT);
+            world.setFluidLevel(x, y, FLUID_MAX - missing);
+            world.fluidEdits.push_back({x, y});
+        }
+    }
+
+    struct Entry {
+        std::uint32_t offset;
+        std::uint32_t size; // 0 = chunk no guardado
+    };
+
+    struct RegionHeader {
+        char magic[4];
+        std::uint32_t version;
+        std::int32_t rx;
+        std::uint32_t chunksY;
+    };
+
+    struct Region {
+        MappedFile map;
+        std::vector<Entry> table;
+    };
+
+    std::string regionPath(int rx) const { return dir + "/r." + std::to_string(rx) + ".bin"; }
+    int slot(int cx, int cy) const { return (cx & (REGION_COLUMNS - 1)) * chunksY + cy; }
+    std::size_t tableBytes() const { return (std::size_t)REGION_COLUMNS * chunksY * sizeof(Entry); }
+
+    // Abre (proyecta) la región rx
+    Region *region(int rx) {
+        auto it = regions.find(rx);
+        if (it != regions.end()) return it->second.get();
+        std::unique_ptr<Region> r(new Region());
+        r->table.assign((std::size_t)REGION_COLUMNS * chunksY, Entry{0, 0});
+        if (r->map.open(regionPath(rx))) {
+            RegionHeader hdr;
+            if (r->map.size() < sizeof(hdr) + tableBytes()) { r->map.close(); }
+            else {
+                std::memcpy(&hdr, r->map.data(), sizeof(hdr));
+                if (std::memcmp(hdr.magic, "MC2R", 4) != 0 || hdr.version != SAVE_VERSION || (int)hdr.chunksY != chunksY) r->map.close();
+                else std::memcpy(r->table.data(), r->map.data() + sizeof(hdr), tableBytes());
+            }
+        }
+        // si no existe se recuerda vacía, para no volver a buscar el fichero en cada carga
+        Region *raw = r.get();
+        regions[rx] = std::move(r);
+        return raw;
+    }
+
+    // Añade al final del fichero los chunks dados y actualiza sus entradas de la tabla;
+    // el resto de la región no se toca. Si el espacio muerto crece demasiado, se compacta.
+    void writeChunks(const World &world, int rx, const std::vector<Chunk *> &chunks) {
+        std::filesystem::create_directories(dir);
+        Region *r = region(rx);
+        std::string path = regionPath(rx);
+        bool exists = r->map.data() != nullptr;
+        r->map.close();
+
+        std::vector<std::vector<unsigned char>> encoded(chunks.size());
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            encode(*chunks[i], encoded[i]);
+            encodeFluid(world, *chunks[i], encoded[i]);
+        }
+
+        if (!exists) {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            RegionHeader hdr;
+            std::memcpy(hdr.magic, "MC2R", 4);
+            hdr.version = SAVE_VERSION; hdr.rx = rx; hdr.chunksY = (std::uint32_t)chunksY;
+            out.write((const char *)&hdr, sizeof(hdr));
+            r->table.assign((std::size_t)REGION_COLUMNS * chunksY, Entry{0, 0});
+            out.write((const char *)r->table.data(), (std::streamsize)tableBytes());
+        }
+        {
+            std::fstream io(path, std::ios::binary | std::ios::in | std::ios::out);
+            io.seekp(0, std::ios::end);
+            for (std::size_t i = 0; i < chunks.size(); ++i) {
+                Entry e;
+                e.offset = (std::uint32_t)io.tellp();
+                e.size = (std::uint32_t)encoded[i].size();
+                io.write((const char *)encoded[i].data(), (std::streamsize)encoded[i].size());
+                r->table[slot(chunks[i]->cx, chunks[i]->cy)] = e;
+                chunks[i]->dirty &= (std::uint8_t)~CHUNK_DIRTY_SAVE;
+            }
+            std::uint64_t fileSize = (std::uint64_t)io.tellp();
+            io.seekp((std::streamoff)sizeof(RegionHeader));
+            io.write((const char *)r->table.data(), (std::streamsize)tableBytes());
+            io.close();
+
+            std::uint64_t live = sizeof(RegionHeader) + tableBytes();
+            for (auto &e : r->table) live += e.size;
+            if (fileSize > live * 2 + 64 * 1024) compact(rx, *r);
+        }
+        r->map.open(path);
+    }
+
+    // Reescribe la región solo con los datos vivos
+    void compact(int rx, Region &r) {
+        std::string path = regionPath(rx);
+        std::vector<char> old;
+        {
+            std::ifstream in(path, std::ios::binary);
+            old.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            out.write(old.data(), (std::streamsize)(sizeof(RegionHeader)));
+            std::vector<Entry> table = r.table;
+            std::uint32_t pos = (std::uint32_t)(sizeof(RegionHeader) + tableBytes());
+            for (auto &e : table) if (e.size) { e.offset = pos; pos += e.size; }
+            out.write((const char *)table.data(), (std::streamsize)tableBytes());
+            for (auto &e : r.table) if (e.size) out.write(old.data() + e.offset, e.size);
+            r.table = table;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmp, path, ec);
+    }
+
+    std::string dir;
+    int chunksY = 0;
+    std::unordered_map<int, std::unique_ptr<Region>> regions;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+
+// Generador pseudoaleatorio pequeño (xorshift32) para la simulación. Cada sistema (IA, apariciones,
+// efectos, clima) tiene el suyo sembrado a partir de la semilla del mundo, así que la misma semilla y
+// la misma entrada dan siempre el mismo resultado, y lo que consuma un sistema no cambia a los demás.
+// Sustituye a std::rand(), que es global y depende de la plataforma.
+class Rng {
+public:
+    explicit Rng(std::uint32_t seed = 1) { reseed(seed); }
+
+    // splitmix32 de la semilla: semillas parecidas dan secuencias sin relación; nunca queda en 0
+    void reseed(std::uint32_t seed) {
+        std::uint32_t z = seed + 0x9E3779B9u;
+        z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+        z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+        state = (z ^ (z >> 16)) | 1u;
+    }
+
+    std::uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Entero en [0, n), n > 0 (como std::rand() % n)
+    int below(int n) { return (int)(next() % (std::uint32_t)n); }
+
+private:
+    std::uint32_t state;
+};
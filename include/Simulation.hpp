@@ -0,0 +1,980 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+#include "Collision.hpp"
+#include "FallingBlocks.hpp"
+#include "FlowField.hpp"
+#include "FluidSim.hpp"
+#include "ItemPool.hpp"
+#include "JobSystem.hpp"
+#include "Lighting.hpp"
+#include "ParticlePool.hpp"
+#include "Profiler.hpp"
+#include "Rng.hpp"
+#include "SpatialHash.hpp"
+#include "World.hpp"
+
+// Simulación del juego separada del render y de la ventana: el bucle principal (o el modo --headless)
+// rellena un SimInput por tick y llama a Simulation::step; el render solo lee el estado resultante.
+
+const int STACK_LIMIT = 999; // máximo de bloques iguales en el inventario
+const std::uint16_t TOOL_DURABILITY = 250;
+
+// Bloques del inventario visible y del selector, en el orden de las teclas 1..0
+constexpr BlockId HOTBAR[] = { GRASS, DIRT, STONE, WOOD, LEAF, COAL, IRON, GOLD, SAND, SNOW, NETH, LAVA };
+constexpr int HOTBAR_SIZE = (int)(sizeof(HOTBAR) / sizeof(HOTBAR[0]));
+
+// Una herramienta del jugador (count 0 = no la tiene)
+struct ItemStack {
+    std::uint16_t count;
+    std::uint16_t durability;
+    std::uint8_t tier;
+};
+
+struct Player {
+    float px, py; // posición en píxeles
+    float vx, vy; // velocidad en píxeles/s
+    int fx, fy;   // dirección de mirada (-1/0/1 en x, y)
+    BlockId selected;
+    std::array<int, BLOCK_COUNT> inv;           // cantidad de cada bloque, indexado por BlockId
+    std::array<ItemStack, TOOL_COUNT> tools;    // indexado por Tool
+    Tool selectedTool;
+    float w, h; // tamaño del rectángulo del jugador
+
+    bool holding(Tool t) const { return selectedTool == t && t != TOOL_NONE && tools[t].count > 0; }
+};
+
+inline bool isSolid(char b){ return BLOCKS[(BlockId)b].solid; }
+
+// El jugador guarda su posición en px, py (ver Collision.hpp)
+inline float &body_x(Player &p) { return p.px; }
+inline float &body_y(Player &p) { return p.py; }
+inline float body_x(const Player &p) { return p.px; }
+inline float body_y(const Player &p) { return p.py; }
+
+// Enemy simple con tipos: ZOMBIE, SKELETON, SPIDER, CREEPER
+struct Enemy {
+    enum Type { ZOMBIE=0, SKELETON=1, SPIDER=2, CREEPER=3 } type;
+    float x, y;
+    float vx, vy;
+    float w, h;
+    int dir; // dirección horizontal preferida (-1 o 1)
+    float moveSpeed;
+    float pauseTimer; // tiempo de pausa para comportamiento torpe
+    // creeper-specific
+    float fuseTimer; // >0 means about to explode
+    bool alive;
+    int hp; // health points
+    int maxHp;
+    float respawnTimer; // seconds until respawn when dead
+    int spawnTileX, spawnTileY; // where to respawn (tile coords)
+};
+
+const int MAX_HEALTH = 5;
+const float REGEN_INTERVAL = 8.0f; // seconds to recover 1 heart (faster)
+const float REGEN_DELAY_AFTER_DAMAGE = 5.0f; // wait after last damage before regen (faster)
+const float GRAVITY = 1500.0f; // px/s^2
+const float MOVE_SPEED = 150.0f; // px/s
+const float JUMP_SPEED = 520.0f; // px/s
+const float MAX_FALL_SPEED = 2000.0f; // px/s
+// Sword (attack) mechanics
+const float SWING_RANGE = 64.0f; // px (increased reach)
+const float SWING_COOLDOWN = 0.5f; // s (quicker swings)
+const float SWING_ACTIVE = 0.15f; // s (shorter hit window)
+const float ENEMY_RESPAWN_BASE = 8.0f; // base seconds before enemy can respawn (faster)
+const float ENEMY_RESPAWN_VAR = 4.0f; // random additional seconds (0..VAR)
+const int SWORD_DAMAGE = 1; // damage per hit
+const float ACTIVE_RANGE = 1200.0f; // px: enemigos más lejos no se simulan
+const float SPIDER_JUMP_MULT = 1.15f; // la araña salta más que el resto
+// Caminos hacia el jugador (FlowField): ventana que cubre ACTIVE_RANGE y tiles que sube cada salto
+const int PATH_RADIUS = (int)(ACTIVE_RANGE / TILE) + 2;
+const int ENEMY_JUMP_TILES = (int)(JUMP_SPEED * JUMP_SPEED / (2.0f * GRAVITY) / TILE);
+const int SPIDER_JUMP_TILES = (int)(JUMP_SPEED * SPIDER_JUMP_MULT * JUMP_SPEED * SPIDER_JUMP_MULT / (2.0f * GRAVITY) / TILE);
+const int PATH_REBUILD_TICKS = 6; // como mucho un recálculo de cada campo cada tantos ticks
+const int CHASE_PATH_COST = 80; // coste máximo de camino (2 por tile andado) para perseguir por él
+const float ENEMY_GRID_CELL = 128.0f; // px: tamaño de celda de la rejilla de enemigos
+const float ENTITY_MARGIN = TILE; // ampliación de las consultas a la rejilla (>= medio tamaño de una entidad)
+const float SEPARATION_SPEED = 40.0f; // px/s con que se separan dos enemigos solapados
+const int EXPLOSION_DAMAGE = 1; // daño de un creeper a los enemigos cercanos
+const int LAVA_DAMAGE = 1; // daño a un enemigo dentro de la lava...
+const int LAVA_DAMAGE_TICKS = 60; // ...cada tantos ticks (el jugador ya tiene su invulnerabilidad)
+const std::size_t FALLING_BLOCK_BUDGET = 64; // bloques con gravedad que pueden bajar en un tick
+const int ENEMY_JOB_GRAIN = 64; // enemigos por trabajo al repartir la IA y la física entre hilos
+const float DAY_LENGTH = 120.0f; // seconds for full day-night cycle
+const float PI = 3.14159265358979323846f;
+const float BASE_BREAK_TIME = 0.6f; // segundos base (ligeramente más rápido)
+const float TOOL_SPEEDUP = 0.45f; // la herramienta preferida del bloque reduce el tiempo de picado
+const float REACH_DISTANCE = 5.0f * TILE; // px del centro del jugador al del tile: hasta dónde pica y pone con el ratón
+
+// Weather system
+enum WeatherMode { WEATHER_NONE = 0, WEATHER_RAIN = 1, WEATHER_SNOW = 2 };
+const float WEATHER_RAIN_SPAWN_PER_SEC = 180.0f; // spawn rate per second per screen
+const float WEATHER_SNOW_SPAWN_PER_SEC = 60.0f;
+// Zona centrada en el jugador donde se genera el clima: cubre la cámara (1280x720) aunque vaya con retraso
+const float WEATHER_AREA_W = 1800.0f, WEATHER_AREA_H = 900.0f;
+const float RAIN_ASPECT = 5.0f; // las gotas se dibujan de 2x10 px
+// Capacidad de los pools de partículas (si se llenan, las nuevas se descartan)
+const std::size_t WEATHER_PARTICLES_MAX = 65536;
+// Effect particles (sparks, explosion debris)
+const std::size_t EFFECT_PARTICLES_MAX = 16384;
+const float EFFECT_GRAVITY = 800.0f; // light gravity
+// Bloques soltados (ItemPool): lo picado y lo que rompe una explosión cae al suelo y se recoge al pasar cerca
+const std::size_t ITEM_CAPACITY = 2048; // si se llena, el nuevo sustituye al que antes iba a desaparecer
+const float ITEM_PICKUP_RADIUS = 40.0f; // px desde el centro del jugador
+const float ITEM_POP_SPEED = 120.0f;    // px/s: salto al soltarse (al picar; en una explosión, hacia fuera)
+
+// La simulación avanza siempre a pasos fijos de SIM_DT; el render interpola entre los dos últimos estados.
+// Si un frame se retrasa no se dan más de MAX_SIM_STEPS pasos para alcanzarlo (el tiempo sobrante se descarta).
+const float SIM_DT = 1.0f / 60.0f;
+const int MAX_SIM_STEPS = 5;
+
+// Entrada de un tick: lo que el jugador (o un guion en modo headless) pide hacer
+struct SimInput {
+    bool moveLeft = false, moveRight = false;
+    bool jump = false;           // pulsación de salto
+    bool breakFacing = false;    // X mantenida: picar el bloque al que se mira
+    bool mouseLeft = false;      // botón izquierdo mantenido: picar bajo el ratón o atacar con espada
+    int mouseTileX = 0, mouseTileY = 0;
+    bool placeFacing = false;    // C: colocar delante
+    bool placeAt = false;        // clic derecho: colocar en placeTileX/Y
+    int placeTileX = 0, placeTileY = 0;
+    int selectBlock = -1;        // >= 0: cambiar bloque seleccionado
+    Tool selectTool = TOOL_NONE; // != TOOL_NONE: cambiar herramienta
+    bool swing = false;          // F: ataque con espada
+    bool toggleWeather = false;  // K
+
+    // las pulsaciones se entregan a un único paso; las teclas mantenidas siguen activas
+    void clearEdges() {
+        jump = placeFacing = placeAt = swing = toggleWeather = false;
+        selectBlock = -1;
+        selectTool = TOOL_NONE;
+    }
+};
+
+// Fases de Simulation::step, para medir cuánto cuesta cada una
+enum SimPhase { PHASE_PLAYER = 0, PHASE_MINING, PHASE_FLUIDS, PHASE_FALLING, PHASE_ENEMIES, PHASE_COMBAT, PHASE_HEALTH, PHASE_PARTICLES, PHASE_ITEMS, PHASE_LIGHT, SIM_PHASE_COUNT };
+static const char* const SIM_PHASE_NAMES[SIM_PHASE_COUNT] = { "player", "mining", "fluids", "falling", "enemies", "combat", "health", "particles", "items", "light" };
+
+// Estado de un jugador dentro de la simulación. Simulation hereda el del jugador local (sim.p,
+// sim.playerHealth...); el servidor guarda uno por cliente y stepPlayers los va cargando por turnos.
+struct PlayerState {
+    Player p{};
+    float spawnPx = 0.0f, spawnPy = 0.0f;
+    int playerHealth = MAX_HEALTH;
+    float playerInvuln = 0.0f; // seconds remaining
+    // fall damage / ground tracking
+    bool wasOnGround = true;
+    int lastGroundTile = 0;
+    int fallStartTile = 0;
+    // health regeneration
+    float regenTimer = 0.0f;
+    float timeSinceDamage = REGEN_DELAY_AFTER_DAMAGE; // seconds since last damage
+    float swingTimer = 0.0f;
+    float swingActive = 0.0f;
+    // Picar bloques por tiempo
+    bool breaking = false;
+    int breakX = -1, breakY = -1;
+    float breakProgress = 0.0f;
+    bool prevMouseLeft = false; // for edge detection of left click
+    float prevPx = 0.0f, prevPy = 0.0f; // posición del paso anterior, para interpolar al dibujar
+    int hurtEvents = 0;                 // veces que el jugador recibió daño en el último step
+};
+
+class Simulation : public PlayerState {
+public:
+    explicit Simulation(World &world) : world(world) {}
+
+    // Coloca al jugador sobre la superficie de la columna tileX con el inventario inicial
+    void spawnPlayer(int tileX) {
+        p = Player{};
+        p.w = TILE-6; p.h = TILE-6;
+        p.px = tileX * TILE; p.vx = 0; p.vy = 0; p.fx = 1; p.fy = 0; p.selected = GRASS;
+        int spawnTileY = 0;
+        for (int y = 0; y < world.height(); ++y) {
+            if (get_block(world, tileX, y) != (char)AIR) { spawnTileY = y - 1; break; }
+        }
+        if (spawnTileY < 0) spawnTileY = world.height() - 6;
+        p.py = spawnTileY * TILE;
+        prevPx = p.px; prevPy = p.py;
+        // store spawn position for respawn on death
+        spawnPx = p.px;
+        spawnPy = p.py;
+        p.inv[GRASS]=10; p.inv[DIRT]=8; p.inv[STONE]=6; p.inv[WOOD]=3;
+        // make new biome/nether blocks placeable
+        p.inv[SAND] = 10;
+        p.inv[SNOW] = 8;
+        p.inv[NETH] = 2;
+        p.inv[LAVA] = 1;
+        // herramientas iniciales
+        for (int t = TOOL_PICKAXE; t < TOOL_COUNT; ++t) p.tools[t] = ItemStack{1, TOOL_DURABILITY, 1};
+        p.selectedTool = TOOL_NONE;
+        resetFallTracking();
+    }
+
+    // Crea un enemigo en una cueva cerca de la columna baseX (no hace nada si no encuentra una)
+    void spawnEnemy(Enemy::Type t, int baseX) {
+        const int H = world.height();
+        // find surface height at baseX
+        int surfaceY = 0;
+        for (int y=0;y<H;++y) { if (get_block(world, baseX, y) != (char)AIR) { surfaceY = y; break; } }
+        // search nearby columns for a cave floor (air tile with solid tile below and y > surfaceY + 2)
+        int foundX=-1, foundY=-1;
+        for (int dx=-8; dx<=8 && foundX==-1; ++dx) {
+            int cx = baseX + dx;
+            for (int y = surfaceY + 3; y < H-2; ++y) {
+                if (get_block(world, cx, y) == (char)AIR && isSolid(get_block(world, cx, y+1))) { foundX = cx; foundY = y; break; }
+            }
+        }
+        if (foundX == -1) return; // no cave found nearby
+        Enemy e{};
+        e.type = t; e.w = p.w; e.h = p.h; e.vx = 0; e.vy = 0; e.dir = spawnRng.below(2)?1:-1; e.moveSpeed = 60.0f; e.pauseTimer = 0.0f; e.fuseTimer = 0.0f; e.alive = true;
+        e.x = foundX * TILE; e.y = (foundY - 1) * TILE; // stand on the block above the floor AIR
+        e.spawnTileX = foundX; e.spawnTileY = foundY - 1;
+        e.respawnTimer = 0.0f;
+        // set HP by type
+        if (t == Enemy::ZOMBIE) { e.maxHp = 2; }
+        else { e.maxHp = 1; }
+        e.hp = e.maxHp;
+        // tweak per type
+        if (t == Enemy::SPIDER) { e.moveSpeed = 80.0f; }
+        if (t == Enemy::CREEPER) { e.moveSpeed = 30.0f; }
+        if (t == Enemy::SKELETON) { e.moveSpeed = 60.0f; }
+        enemies.push_back(e);
+        if (grid.size() + 1 == enemies.size()) grid.insert((int)enemies.size() - 1, e.x + e.w*0.5f, e.y + e.h*0.5f);
+    }
+
+    // Olvida el estado anterior (tras teletransportes como cargar partida) para no interpolar desde lejos
+    void snapInterpolation() {
+        rebuildIndex();
+        prevPx = p.px; prevPy = p.py;
+        enemyPrev.clear();
+        for (auto &e : enemies) enemyPrev.push_back(sf::Vector2f(e.x, e.y));
+    }
+
+    // Posiciones para dibujar: alpha = fracción del siguiente paso ya transcurrida (0..1)
+    sf::Vector2f playerDrawPos(float alpha) const {
+        return sf::Vector2f(prevPx + (p.px - prevPx) * alpha, prevPy + (p.py - prevPy) * alpha);
+    }
+    sf::Vector2f enemyDrawPos(std::size_t i, float alpha) const {
+        const Enemy &e = enemies[i];
+        if (i >= enemyPrev.size()) return sf::Vector2f(e.x, e.y);
+        return sf::Vector2f(enemyPrev[i].x + (e.x - enemyPrev[i].x) * alpha, enemyPrev[i].y + (e.y - enemyPrev[i].y) * alpha);
+    }
+
+    void resetFallTracking() {
+        wasOnGround = true;
+        lastGroundTile = static_cast<int>(std::floor((p.py + p.h) / TILE));
+        fallStartTile = lastGroundTile;
+    }
+
+    // 0..1: altura del sol según la hora del día
+    float sun() const {
+        float phase = std::fmod(dayTime, DAY_LENGTH) / DAY_LENGTH; // 0..1
+        return 0.5f + 0.5f * std::sin(phase * 2.0f * PI);
+    }
+    float ambient() const { return 0.4f + 0.6f * sun(); } // 0.4..1.0
+
+    // segundos que cuesta picar el bloque tb con la herramienta seleccionada (< 0: no se puede)
+    float breakTime(char tb) {
+        const BlockInfo &info = BLOCKS[(BlockId)tb];
+        if (tb == (char)AIR || info.hardness < 0.0f) return -1.0f;
+        float mult = info.hardness;
+        // tool modifiers: improved pickaxe/axe/shovel effectiveness
+        if (p.holding(info.tool)) mult *= TOOL_SPEEDUP;
+        return BASE_BREAK_TIME * mult;
+    }
+
+    // Avanza la simulación dt segundos
+    void step(const SimInput &in, float dt) {
+        hurtEvents = 0;
+        savePrevious();
+        auto t0 = std::chrono::steady_clock::now();
+        stepPlayer(in, dt);
+        dayTime += dt; // advance day-night time
+        lap(PHASE_PLAYER, t0);
+        stepMining(in, dt);
+        lap(PHASE_MINING, t0);
+        stepFluids();
+        lavaDamage();
+        lap(PHASE_FLUIDS, t0);
+        items.step(world, dt, GRAVITY, MAX_FALL_SPEED); // antes de falling.step, que vacía los fallEdits con que se despiertan
+        collectItems();
+        lap(PHASE_ITEMS, t0);
+        falling.step(world);
+        lap(PHASE_FALLING, t0);
+        targets.assign(1, sf::Vector2f(p.px + p.w*0.5f, p.py + p.h*0.5f));
+        stepEnemies(dt);
+        hurtByEnemies();
+        lap(PHASE_ENEMIES, t0);
+        stepCombat(in);
+        lap(PHASE_COMBAT, t0);
+        stepHealth(dt);
+        lap(PHASE_HEALTH, t0);
+        stepParticles(dt);
+        lap(PHASE_PARTICLES, t0);
+        ++ticks;
+    }
+
+    // Paso con varios jugadores (servidor): players[k] hace inputs[k]. Lo de cada jugador (moverse, picar,
+    // lava, golpes de enemigos, espada, vida) se hace con su estado cargado en el de Simulation; el mundo y
+    // los enemigos avanzan una vez. Se mueven los enemigos cercanos a cualquier jugador y cada uno va a por
+    // el más cercano; el campo de caminos (uno solo) lleva a players[0], a los demás se va en línea recta.
+    // No hay partículas: el servidor no dibuja, así que las chispas se descartan.
+    void stepPlayers(PlayerState *players, const SimInput *inputs, int count, float dt) {
+        savePrevious();
+        auto t0 = std::chrono::steady_clock::now();
+        for (int k = 0; k < count; ++k) withPlayer(players[k], [&]{ hurtEvents = 0; stepPlayer(inputs[k], dt); });
+        dayTime += dt;
+        lap(PHASE_PLAYER, t0);
+        for (int k = 0; k < count; ++k) withPlayer(players[k], [&]{ stepMining(inputs[k], dt); });
+        lap(PHASE_MINING, t0);
+        stepFluids();
+        for (int k = 0; k < count; ++k) withPlayer(players[k], [&]{ lavaDamage(); });
+        lap(PHASE_FLUIDS, t0);
+        items.step(world, dt, GRAVITY, MAX_FALL_SPEED);
+        for (int k = 0; k < count; ++k) withPlayer(players[k], [&]{ collectItems(); });
+        lap(PHASE_ITEMS, t0);
+        falling.step(world);
+        lap(PHASE_FALLING, t0);
+        if (count > 0) {
+            targets.clear();
+            for (int k = 0; k < count; ++k) targets.push_back(sf::Vector2f(players[k].p.px + players[k].p.w*0.5f, players[k].p.py + players[k].p.h*0.5f));
+            withPlayer(players[0], [&]{ stepEnemies(dt); });
+            for (int k = 0; k < count; ++k) withPlayer(players[k], [&]{ hurtByEnemies(); });
+        }
+        lap(PHASE_ENEMIES, t0);
+        for (int k = 0; k < count; ++k) withPlayer(players[k], [&]{ stepCombat(inputs[k]); });
+        lap(PHASE_COMBAT, t0);
+        for (int k = 0; k < count; ++k) withPlayer(players[k], [&]{ stepHealth(dt); });
+        lap(PHASE_HEALTH, t0);
+        effectParticles.clear();
+        weatherParticles.clear();
+        lap(PHASE_PARTICLES, t0);
+        ++ticks;
+    }
+
+    // Pasa al inventario todo lo soltado que siga en el suelo (ItemPool no se guarda): llamar antes de
+    // guardar la partida para no perder lo picado. Devuelve los bloques que entraron.
+    int creditItems() {
+        return items.collectAll([&](BlockId b, int n){ return addToInventory(b, n); });
+    }
+
+    // Un jugador nuevo en ps, sobre la superficie de la columna tileX (ver spawnPlayer)
+    void spawnPlayerInto(PlayerState &ps, int tileX) { withPlayer(ps, [&]{ spawnPlayer(tileX); }); }
+
+    // Aplica de una vez los cambios de luz acumulados (bloques puestos/quitados, columnas cargadas).
+    // Se llama una vez por frame, después de los pasos de simulación, no en cada step.
+    void updateLight() {
+        auto t0 = std::chrono::steady_clock::now();
+        light.update(world, jobs);
+        lap(PHASE_LIGHT, t0);
+    }
+
+    World &world;
+    float dayTime = 0.0f;
+
+    std::vector<Enemy> enemies;   // si se sustituye entero (cargar partida), llamar a snapInterpolation()
+    std::vector<sf::Vector2f> enemyPrev; // posiciones del paso anterior, para interpolar al dibujar
+    int weatherMode = WEATHER_NONE;
+    float weatherIntensity = 1.0f; // multiplica la frecuencia de aparición de lluvia/nieve
+    ParticlePool weatherParticles{WEATHER_PARTICLES_MAX};
+    float weatherSpawnAcc = 0.0f;
+    ParticlePool effectParticles{EFFECT_PARTICLES_MAX};
+    ItemPool items{ITEM_CAPACITY}; // bloques soltados en el suelo (no se guardan: ver creditItems)
+
+    LightEngine light;
+    FluidSim fluids;
+    FallingBlocks falling{FALLING_BLOCK_BUDGET};
+    // caminos hacia el jugador, compartidos por todos los enemigos (uno por altura de salto)
+    FlowField groundPaths{PATH_RADIUS, ENEMY_JUMP_TILES, PATH_REBUILD_TICKS};
+    FlowField spiderPaths{PATH_RADIUS, SPIDER_JUMP_TILES, PATH_REBUILD_TICKS};
+
+    SpatialHash grid{ENEMY_GRID_CELL};
+    FrameProfiler *profiler = nullptr;
+    JobSystem *jobs = nullptr; // sin él todo va en el hilo que llama a step
+    int profilerIds[SIM_PHASE_COUNT] = {};
+    // aleatoriedad por sistema (ver Rng.hpp); seedRandom() las siembra con la semilla del mundo
+    // (la IA no tiene uno compartido: cada enemigo saca el suyo de aiSeed con enemyRng)
+    std::uint32_t aiSeed = 0;
+    Rng spawnRng, effectRng, weatherRng, itemRng;
+    std::vector<int> dead;          // índices de enemigos muertos esperando reaparecer
+    std::vector<int> active, moving, hits;  // listas temporales reutilizadas en cada paso
+    std::vector<sf::Vector2f> targets;      // centros de los jugadores a los que van los enemigos (stepEnemies)
+    std::vector<std::uint8_t> actions;      // lo que decidió cada enemigo de active (ACTION_*)
+    struct Blast { float x, y, radius; };
+    std::vector<Blast> blasts;              // explosiones de creeper del último paso
+
+    std::uint64_t ticks = 0;
+    std::uint64_t phaseNs[SIM_PHASE_COUNT] = {}; // tiempo acumulado por fase
+
+    // Siembra los generadores de cada sistema; con la misma semilla y la misma entrada, mismo resultado
+    void seedRandom(std::uint32_t seed) {
+        aiSeed = seed ^ 0xA1A1A1A1u;
+        spawnRng.reseed(seed ^ 0x5B5B5B5Bu);
+        effectRng.reseed(seed ^ 0xEFEFEFEFu);
+        weatherRng.reseed(seed ^ 0x3C3C3C3Cu);
+        itemRng.reseed(seed ^ 0x1D1D1D1Du);
+    }
+
+    // Huella del estado (jugador, enemigos, objetos soltados, tiempo y bloques cargados) para comparar dos ejecuciones
+    std::uint64_t stateHash() const {
+        std::uint64_t h = 1469598103934665603ULL; // FNV-1a
+        auto mix = [&](const void *data, std::size_t n){
+            const unsigned char *b = (const unsigned char *)data;
+            for (std::size_t i = 0; i < n; ++i) h = (h ^ b[i]) * 1099511628211ULL;
+        };
+        mix(&ticks, sizeof(ticks));
+        mix(&p.px, sizeof(p.px)); mix(&p.py, sizeof(p.py)); mix(&p.vx, sizeof(p.vx)); mix(&p.vy, sizeof(p.vy));
+        mix(p.inv.data(), sizeof(int) * p.inv.size());
+        mix(&playerHealth, sizeof(playerHealth)); mix(&dayTime, sizeof(dayTime));
+        for (const Enemy &e : enemies) {
+            mix(&e.x, sizeof(e.x)); mix(&e.y, sizeof(e.y)); mix(&e.hp, sizeof(e.hp)); mix(&e.alive, sizeof(e.alive));
+        }
+        items.forEach([&](int id, const ItemPool::Item &it){
+            mix(&id, sizeof(id)); mix(&it.x, sizeof(it.x)); mix(&it.y, sizeof(it.y)); mix(&it.block, 1); mix(&it.count, sizeof(it.count));
+        });
+        world.forEachColumn([&](int cx){
+            mix(&cx, sizeof(cx));
+            for (int y = 0; y < world.height(); ++y)
+                for (int x = cx * CHUNK_SIZE; x < (cx + 1) * CHUNK_SIZE; ++x) { BlockId b = world.get(x, y); mix(&b, 1); }
+        });
+        return h;
+    }
+
+    // Además de phaseNs, cada fase se apunta en el perfilador de frames (si hay)
+    void attachProfiler(FrameProfiler &fp) {
+        profiler = &fp;
+        for (int i = 0; i < SIM_PHASE_COUNT; ++i) profilerIds[i] = fp.scope(SIM_PHASE_NAMES[i]);
+    }
+
+    // Reparte enemigos, partículas y luz entre los hilos de js (el resultado es el mismo que sin él)
+    void attachJobs(JobSystem &js) { jobs = &js; }
+
+private:
+    // Lo que decide cada enemigo activo en stepEnemies
+    enum : std::uint8_t { ACTION_IDLE = 0, ACTION_MOVE, ACTION_EXPLODE };
+
+    // Ejecuta f con ps cargado como jugador de la simulación y lo devuelve a ps después
+    template <class F>
+    void withPlayer(PlayerState &ps, F &&f) {
+        std::swap(static_cast<PlayerState &>(*this), ps);
+        f();
+        std::swap(static_cast<PlayerState &>(*this), ps);
+    }
+
+    void savePrevious() {
+        prevPx = p.px; prevPy = p.py;
+        enemyPrev.resize(enemies.size());
+        for (std::size_t i = 0; i < enemies.size(); ++i) enemyPrev[i] = sf::Vector2f(enemies[i].x, enemies[i].y);
+        weatherParticles.savePrevious();
+        effectParticles.savePrevious();
+        items.savePrevious();
+    }
+
+    void lap(SimPhase phase, std::chrono::steady_clock::time_point &t0) {
+        auto t1 = std::chrono::steady_clock::now();
+        phaseNs[phase] += (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+        if (profiler) profiler->record(profilerIds[phase], t0, t1);
+        t0 = t1;
+    }
+
+    void hurtPlayer() {
+        playerHealth = std::max(0, playerHealth - 1);
+        playerInvuln = 1.0f;
+        timeSinceDamage = 0.0f;
+        ++hurtEvents;
+    }
+
+    void spawnSparks(float x, float y, int count, float speed, float life, float lifeVar, float size, int sizeVar, bool explosion) {
+        for (int i = 0; i < count; ++i) {
+            float vx = (effectRng.below(200) - 100) * speed;
+            float vy = (effectRng.below(200) - 200) * speed;
+            float l = life + effectRng.below(100) / lifeVar;
+            float radius = size + effectRng.below(sizeVar);
+            sf::Color col = explosion ? ((i%2==0) ? sf::Color(255,180,60) : sf::Color(180,80,40)) : sf::Color(255,220,160);
+            effectParticles.spawn(x, y, vx, vy, l, radius * 2.0f, col);
+        }
+    }
+
+    void stepPlayer(const SimInput &in, float dt) {
+        if (in.selectBlock >= 0 && in.selectBlock < BLOCK_COUNT) p.selected = (BlockId)in.selectBlock;
+        if (in.selectTool != TOOL_NONE) p.selectedTool = p.tools[in.selectTool].count > 0 ? in.selectTool : TOOL_NONE;
+        if (in.toggleWeather) {
+            // cycle weather: none -> rain -> snow -> none
+            weatherMode = (weatherMode + 1) % 3;
+            weatherParticles.clear();
+        }
+        if (in.placeFacing) {
+            int tx = tile_of(p.px + p.w/2 + p.fx * TILE);
+            int ty = tile_of(p.py + p.h/2 + p.fy * TILE);
+            BlockId b = p.selected;
+            if (in_bounds(world, tx,ty) && get_block(world,tx,ty)==(char)AIR && p.inv[b]>0){ p.inv[b]--; set_block(world,tx,ty,(char)b); }
+        }
+        if (in.placeAt && in_bounds(world, in.placeTileX, in.placeTileY) && inReach(in.placeTileX, in.placeTileY)) {
+            BlockId b = p.selected;
+            if (get_block(world,in.placeTileX,in.placeTileY)==(char)AIR && p.inv[b]>0){ p.inv[b]--; set_block(world,in.placeTileX,in.placeTileY,(char)b); }
+        }
+        // Salto: solo si estamos sobre suelo
+        if (in.jump && on_ground(world, p)) p.vy = -JUMP_SPEED;
+        // sword attack: only swing if sword is selected
+        if (in.swing && p.holding(TOOL_SWORD)) {
+            if (swingTimer <= 0.0f) { swingTimer = SWING_COOLDOWN; swingActive = SWING_ACTIVE; }
+        }
+
+        // update swing timers
+        if (swingTimer > 0.0f) swingTimer = std::max(0.0f, swingTimer - dt);
+        if (swingActive > 0.0f) swingActive = std::max(0.0f, swingActive - dt);
+
+        // Input horizontal
+        float targetVx = 0;
+        if (in.moveLeft) { targetVx = -MOVE_SPEED; p.fx = -1; }
+        else if (in.moveRight) { targetVx = MOVE_SPEED; p.fx = 1; }
+        p.vx = targetVx;
+
+        // Apply gravity
+        p.vy += GRAVITY * dt;
+        if (p.vy > MAX_FALL_SPEED) p.vy = MAX_FALL_SPEED;
+
+        // Move and resolve collisions (horizontal, then vertical)
+        std::uint8_t contacts = move_body(world, p, dt);
+
+        // update facing y
+        p.fy = (p.vy > 0) ? 1 : (p.vy < 0 ? -1 : 0);
+
+        // Fall damage detection: check landing and start-fall
+        int belowTileY = static_cast<int>(std::floor((p.py + p.h + 1) / TILE));
+        bool onGround = (contacts & CONTACT_GROUND) || on_ground(world, p);
+        if (!wasOnGround && onGround) {
+            // landed
+            int dropTiles = belowTileY - fallStartTile;
+            if (dropTiles >= 5 && playerInvuln <= 0.0f) hurtPlayer();
+        }
+        if (wasOnGround && !onGround) {
+            // started falling: record the ground tile we left
+            fallStartTile = lastGroundTile;
+        }
+        if (onGround) lastGroundTile = belowTileY;
+        wasOnGround = onGround;
+    }
+
+    // ¿Está el tile (tx, ty) al alcance del jugador? Las coordenadas de ratón llegan tal cual de la
+    // entrada (en el servidor, de la red), así que se comprueban antes de tocar el mundo con ellas.
+    bool inReach(int tx, int ty) const {
+        return std::hypot((tx + 0.5f) * TILE - (p.px + p.w*0.5f), (ty + 0.5f) * TILE - (p.py + p.h*0.5f)) <= REACH_DISTANCE;
+    }
+
+    // --- Mecánica de picar por tiempo / ataque con clic izquierdo ---
+    void stepMining(const SimInput &in, float dt) {
+        // if sword is selected, left-click triggers attack on press instead of mining
+        bool mouseBreak = in.mouseLeft && !p.holding(TOOL_SWORD);
+        int targetX = -1, targetY = -1;
+        bool hasTarget = false;
+        if (in.breakFacing) {
+            targetX = tile_of(p.px + p.w/2 + p.fx * TILE);
+            targetY = tile_of(p.py + p.h/2 + p.fy * TILE);
+            hasTarget = true;
+        } else if (mouseBreak && inReach(in.mouseTileX, in.mouseTileY)) {
+            targetX = in.mouseTileX; targetY = in.mouseTileY;
+            hasTarget = true;
+        }
+
+        if (hasTarget && in_bounds(world, targetX, targetY)) {
+            char tb = get_block(world, targetX, targetY);
+            float need = breakTime(tb);
+            if (need >= 0.0f) {
+                if (breaking && breakX == targetX && breakY == targetY) {
+                    breakProgress += dt;
+                } else {
+                    breaking = true;
+                    breakX = targetX; breakY = targetY; breakProgress = dt;
+                }
+
+                if (breakProgress >= need) {
+                    // completar ruptura: el bloque salta del hueco y se recoge al pasar (collectItems)
+                    set_block(world, breakX, breakY, (char)AIR);
+                    dropBlock(breakX, breakY, (BlockId)tb, 0.0f, -ITEM_POP_SPEED);
+                    breaking = false; breakX = breakY = -1; breakProgress = 0.0f;
+                }
+                return;
+            }
+        }
+        // no está picando (o el objetivo no es picable)
+        breaking = false; breakX = breakY = -1; breakProgress = 0.0f;
+    }
+
+    // Actualizar enemigos: solo los que la rejilla encuentra a menos de ACTIVE_RANGE de algún jugador de
+    // targets (el primero es el jugador cargado, al que llevan los campos de caminos). Decidir, separarse y moverse va en paralelo (cada enemigo escribe solo en sí mismo y su azar sale
+    // de enemyRng); las explosiones tocan el mundo y a otros enemigos, así que se aplican en serie y en
+    // orden entre medias. El resultado no depende del número de hilos.
+    void stepEnemies(float dt) {
+        blasts.clear();
+        if (grid.size() != enemies.size()) rebuildIndex();
+        if (!enemies.empty()) updatePaths();
+        // respawn timers for dead ones (solo se recorren los muertos)
+        for (std::size_t k = 0; k < dead.size();) {
+            Enemy &e = enemies[dead[k]];
+            if (e.respawnTimer > 0.0f) e.respawnTimer = std::max(0.0f, e.respawnTimer - dt);
+            if (e.respawnTimer <= 0.0f) respawnEnemy(dead[k]);
+            if (e.alive) { dead[k] = dead.back(); dead.pop_back(); } else ++k;
+        }
+
+        active.clear();
+        moving.clear();
+        for (const sf::Vector2f &t : targets)
+            grid.query(t.x - ACTIVE_RANGE, t.y - ACTIVE_RANGE, t.x + ACTIVE_RANGE, t.y + ACTIVE_RANGE,
+                       [&](int id){ if (enemies[id].alive) active.push_back(id); });
+        std::sort(active.begin(), active.end()); // mismo orden que antes, independiente de la rejilla
+        active.erase(std::unique(active.begin(), active.end()), active.end()); // cerca de dos jugadores: una vez
+        actions.assign(active.size(), ACTION_IDLE);
+        parallel_for(jobs, 0, (int)active.size(), ENEMY_JOB_GRAIN, [&](int k0, int k1){
+            for (int k = k0; k < k1; ++k) actions[k] = decideEnemy(active[k], dt);
+        });
+        for (std::size_t k = 0; k < active.size(); ++k)
+            if (actions[k] == ACTION_EXPLODE && enemies[active[k]].alive) explodeCreeper(active[k]);
+
+        // separación entre enemigos: apartarse en horizontal del primer vecino solapado.
+        // Basta uno por paso, así el coste no crece con el tamaño de un grupo apelotonado.
+        parallel_for(jobs, 0, (int)active.size(), ENEMY_JOB_GRAIN, [&](int k0, int k1){
+            for (int k = k0; k < k1; ++k) {
+                int i = active[k];
+                Enemy &e = enemies[i];
+                if (actions[k] == ACTION_IDLE || !e.alive) { actions[k] = ACTION_IDLE; continue; }
+                int o = grid.findFirst(e.x - ENTITY_MARGIN, e.y - ENTITY_MARGIN, e.x + e.w + ENTITY_MARGIN, e.y + e.h + ENTITY_MARGIN, [&](int j){
+                    const Enemy &n = enemies[j];
+                    return j != i && n.alive && overlaps(e.x, e.y, e.w, e.h, n.x, n.y, n.w, n.h);
+                });
+                if (o >= 0) e.vx += (e.x < enemies[o].x || (e.x == enemies[o].x && i < o)) ? -SEPARATION_SPEED : SEPARATION_SPEED;
+            }
+        });
+        for (std::size_t k = 0; k < active.size(); ++k) if (actions[k] != ACTION_IDLE) moving.push_back(active[k]);
+
+        // física de todos los que se mueven, después de decidir todos (cada cuerpo solo lee el mundo)
+        parallel_for(jobs, 0, (int)moving.size(), ENEMY_JOB_GRAIN, [&](int k0, int k1){
+            move_bodies(world, enemies.data(), moving.data() + k0, (std::size_t)(k1 - k0), dt);
+        });
+        for (int i : moving) grid.update(i, enemies[i].x + enemies[i].w*0.5f, enemies[i].y + enemies[i].h*0.5f);
+    }
+
+    // Daño al jugador cargado de las explosiones de este paso y del primer enemigo que lo toca
+    void hurtByEnemies() {
+        float pcx = p.px + p.w*0.5f, pcy = p.py + p.h*0.5f;
+        for (const Blast &b : blasts)
+            if (playerInvuln <= 0.0f && std::hypot(pcx - b.x, pcy - b.y) < b.radius) hurtPlayer();
+        // collision damage to player (creeper handled on explosion)
+        if (playerInvuln <= 0.0f) {
+            int toucher = grid.findFirst(p.px - ENTITY_MARGIN, p.py - ENTITY_MARGIN, p.px + p.w + ENTITY_MARGIN, p.py + p.h + ENTITY_MARGIN, [&](int id){
+                const Enemy &e = enemies[id];
+                return e.alive && e.type != Enemy::CREEPER && overlaps(e.x, e.y, e.w, e.h, p.px, p.py, p.w, p.h);
+            });
+            if (toucher >= 0) hurtPlayer();
+        }
+    }
+
+    // Índice en targets del jugador más cercano a (x, y) (el primero si empatan); -1 si no hay ninguno
+    int nearestTarget(float x, float y) const {
+        int best = -1;
+        float bestD = 0.0f;
+        for (std::size_t k = 0; k < targets.size(); ++k) {
+            const float d = std::hypot(targets[k].x - x, targets[k].y - y);
+            if (best < 0 || d < bestD) { best = (int)k; bestD = d; }
+        }
+        return best;
+    }
+
+    // Azar propio de cada enemigo en cada tick: no depende de en qué hilo ni en qué orden se decida
+    Rng enemyRng(int i) const {
+        return Rng(aiSeed ^ (std::uint32_t)ticks * 0x9E3779B1u ^ (std::uint32_t)i * 0x85EBCA6Bu);
+    }
+
+    // Velocidad y mecha del enemigo i; solo escribe en enemies[i]
+    std::uint8_t decideEnemy(int i, float dt) {
+        Enemy &e = enemies[i];
+        float exCenter = e.x + e.w*0.5f;
+        // a por el jugador más cercano; los caminos solo llevan al primero
+        const int target = nearestTarget(exCenter, e.y + e.h*0.5f);
+        if (target < 0) return ACTION_IDLE;
+        const float pxCenter = targets[target].x, pyCenter = targets[target].y;
+        const bool usePaths = target == 0;
+        float dxE = pxCenter - exCenter;
+        float dyE = pyCenter - (e.y + e.h*0.5f);
+        float dist = std::hypot(dxE, dyE);
+        if (dist >= ACTIVE_RANGE) return ACTION_IDLE;
+
+        e.vy += GRAVITY * dt;
+        if (e.vy > MAX_FALL_SPEED) e.vy = MAX_FALL_SPEED;
+
+        Rng rng = enemyRng(i);
+        float distE = std::abs(dxE);
+        if (e.pauseTimer > 0.0f) { e.pauseTimer -= dt; e.vx = 0.0f; }
+        else {
+            if (e.type == Enemy::ZOMBIE || e.type == Enemy::SKELETON) {
+                if (usePaths && followPath(e, groundPaths, JUMP_SPEED)) { /* por el camino hacia el jugador */ }
+                else if (distE < 500.0f) e.vx = (dxE > 0.0f) ? e.moveSpeed : -e.moveSpeed;
+                else { e.vx = e.moveSpeed * e.dir; if (rng.below(1000) < 8) { e.dir = -e.dir; e.pauseTimer = 0.35f; e.vx = 0.0f; } }
+            } else if (e.type == Enemy::SPIDER) {
+                // spider: can jump higher towards player
+                bool onGround = on_ground(world, e);
+                if (usePaths && followPath(e, spiderPaths, JUMP_SPEED * SPIDER_JUMP_MULT)) { /* por el camino hacia el jugador */ }
+                else if (distE < 500.0f) e.vx = (dxE > 0.0f) ? e.moveSpeed : -e.moveSpeed;
+                else e.vx = e.moveSpeed * e.dir;
+                if (onGround && distE < 250.0f && rng.below(100) < 25) { e.vy = -JUMP_SPEED * SPIDER_JUMP_MULT; }
+            } else if (e.type == Enemy::CREEPER) {
+                // creeper: slow approach, when close start fuse and explode
+                const float triggerDist = 160.0f;
+                if (distE < triggerDist && e.fuseTimer <= 0.0f) { e.fuseTimer = 1.6f; }
+                if (e.fuseTimer > 0.0f) { e.fuseTimer -= dt; if (e.fuseTimer <= 0.0f) return ACTION_EXPLODE; }
+                // approach slowly while not fusing
+                if (e.fuseTimer <= 0.0f) {
+                    if (usePaths && followPath(e, groundPaths, JUMP_SPEED)) { /* por el camino hacia el jugador */ }
+                    else if (distE < 500.0f) e.vx = (dxE > 0.0f) ? e.moveSpeed : -e.moveSpeed; else e.vx = e.moveSpeed * e.dir;
+                } else e.vx = 0.0f; // fuse pause movement
+            }
+        }
+        return ACTION_MOVE;
+    }
+
+    // Flujo de lava y daño a los enemigos que la tocan (una vez cada LAVA_DAMAGE_TICKS)
+    void stepFluids() {
+        fluids.step(world);
+        if (ticks % LAVA_DAMAGE_TICKS != 0) return;
+        for (std::size_t i = 0; i < enemies.size(); ++i) {
+            Enemy &e = enemies[i];
+            if (!e.alive || !touches_block(world, e, LAVA)) continue;
+            e.hp -= LAVA_DAMAGE;
+            if (e.hp <= 0) killEnemy((int)i);
+        }
+    }
+
+    // El jugador cargado se quema si toca lava
+    void lavaDamage() {
+        if (playerInvuln <= 0.0f && touches_block(world, p, LAVA)) hurtPlayer();
+    }
+
+    // Los campos de flujo apuntan al tile donde está de pie el jugador (o al suelo bajo él si está saltando)
+    void updatePaths() {
+        int tx = static_cast<int>(std::floor((p.px + p.w*0.5f) / TILE));
+        int ty = static_cast<int>(std::floor((p.py + p.h - 1) / TILE));
+        for (int k = 0; k <= SPIDER_JUMP_TILES + 1; ++k) {
+            if (!FlowField::standable(world, tx, ty + k)) continue;
+            groundPaths.update(world, tx, ty + k, ticks);
+            spiderPaths.update(world, tx, ty + k, ticks);
+            return;
+        }
+        // en plena caída: se mantiene el objetivo anterior
+    }
+
+    // Mueve e por el campo de flujo; false si no está sobre un camino hasta el jugador (o ya ha llegado).
+    // En el aire sigue la dirección del nodo que tiene debajo, para terminar el salto o la caída.
+    bool followPath(Enemy &e, const FlowField &field, float jumpSpeed) {
+        int tx = static_cast<int>(std::floor((e.x + e.w*0.5f) / TILE));
+        int ty = static_cast<int>(std::floor((e.y + e.h - 1) / TILE));
+        bool onGround = on_ground(world, e);
+        for (int k = 0; k <= SPIDER_JUMP_TILES + 1; ++k) {
+            FlowField::Step s = field.sample(tx, ty + k);
+            if (!s.valid) { if (onGround) return false; continue; }
+            if (s.dist == 0 || s.dist > CHASE_PATH_COST) return false;
+            e.dir = s.dir;
+            e.vx = s.dir * e.moveSpeed;
+            if (s.jump && k == 0 && onGround) e.vy = -jumpSpeed;
+            return true;
+        }
+        return false;
+    }
+
+    static bool overlaps(float ax, float ay, float aw, float ah, float bx, float by, float bw, float bh) {
+        return ax < bx + bw && ax + aw > bx && ay < by + bh && ay + ah > by;
+    }
+
+    void killEnemy(int i) {
+        Enemy &e = enemies[i];
+        e.alive = false;
+        e.vx = e.vy = 0.0f;
+        // randomized respawn time
+        e.respawnTimer = ENEMY_RESPAWN_BASE + spawnRng.below((int)ENEMY_RESPAWN_VAR + 1);
+        dead.push_back(i);
+    }
+
+    void explodeCreeper(int i) {
+        Enemy &e = enemies[i];
+        // explode: clear nearby blocks (2-tile radius)
+        int radiusTiles = 2;
+        int cx = static_cast<int>(std::floor((e.x + e.w*0.5f) / TILE));
+        int cy = static_cast<int>(std::floor((e.y + e.h*0.5f) / TILE));
+        for (int oy = -radiusTiles; oy <= radiusTiles; ++oy) for (int ox = -radiusTiles; ox <= radiusTiles; ++ox) {
+            int bx = cx + ox; int by = cy + oy;
+            if (!in_bounds(world, bx,by)) continue;
+            const BlockId b = (BlockId)get_block(world,bx,by);
+            if (BLOCKS[b].hardness < 0.0f) continue;
+            set_block(world,bx,by,(char)AIR);
+            // lo que no es aire ni fluido sale despedido hacia fuera
+            if (b != AIR && !BLOCKS[b].flow) dropBlock(bx, by, b, ox * ITEM_POP_SPEED, (oy - 1) * ITEM_POP_SPEED);
+        }
+        // spawn explosion effect particles
+        float ex = e.x + e.w*0.5f; float ey = e.y + e.h*0.5f;
+        spawnSparks(ex, ey, 20, 3.0f, 0.8f, 200.0f, 2.0f, 6, true);
+        float blast = radiusTiles * TILE + 8.0f;
+        blasts.push_back({ex, ey, blast}); // el daño a los jugadores, en hurtByEnemies
+        killEnemy(i);
+        // y a los enemigos alcanzados
+        grid.query(ex - blast, ey - blast, ex + blast, ey + blast, [&](int j){
+            Enemy &o = enemies[j];
+            if (!o.alive || std::hypot(o.x + o.w*0.5f - ex, o.y + o.h*0.5f - ey) >= blast) return;
+            o.hp -= EXPLOSION_DAMAGE;
+            if (o.hp <= 0) killEnemy(j);
+        });
+    }
+
+    // Suelta un bloque desde el centro del tile (tx, ty) con velocidad (vx, vy) y algo de dispersión
+    void dropBlock(int tx, int ty, BlockId b, float vx, float vy) {
+        const float jitter = ITEM_POP_SPEED * 0.25f;
+        items.spawn(tx * TILE + (TILE - ItemPool::SIZE) * 0.5f, ty * TILE + (TILE - ItemPool::SIZE) * 0.5f, b, 1,
+                    vx + (itemRng.below(201) - 100) * 0.01f * jitter, vy - itemRng.below(101) * 0.01f * jitter);
+    }
+
+    // El jugador recoge lo que tiene cerca, hasta STACK_LIMIT de cada bloque (lo que no cabe se queda)
+    void collectItems() {
+        items.collect(p.px + p.w*0.5f, p.py + p.h*0.5f, ITEM_PICKUP_RADIUS, [&](BlockId b, int n){ return addToInventory(b, n); });
+    }
+
+    // Mete hasta n bloques b en el inventario sin pasar de STACK_LIMIT; devuelve cuántos caben
+    int addToInventory(BlockId b, int n) {
+        const int take = std::max(0, std::min(n, STACK_LIMIT - p.inv[b]));
+        p.inv[b] += take;
+        return take;
+    }
+
+    // Rehace la rejilla y la lista de muertos (tras crear enemigos o cargar partida)
+    void rebuildIndex() {
+        grid.clear();
+        dead.clear();
+        for (std::size_t i = 0; i < enemies.size(); ++i) {
+            const Enemy &e = enemies[i];
+            grid.insert((int)i, e.x + e.w*0.5f, e.y + e.h*0.5f);
+            if (!e.alive) dead.push_back((int)i);
+        }
+    }
+
+    // respawn de enemigos muertos: se pospone si el jugador está cerca y se busca un sitio seguro cercano
+    void respawnEnemy(int i) {
+        Enemy &e = enemies[i];
+        float spawnCx = e.spawnTileX * TILE + TILE*0.5f;
+        float spawnCy = e.spawnTileY * TILE + TILE*0.5f;
+        // ningún jugador demasiado cerca del punto de aparición
+        const int near = nearestTarget(spawnCx, spawnCy);
+        if (near >= 0 && std::hypot(targets[near].x - spawnCx, targets[near].y - spawnCy) < 5.0f * TILE) {
+            // push respawn a bit further
+            e.respawnTimer = 2.0f + spawnRng.below(3);
+            return;
+        }
+        // search for a nearby suitable tile (air with solid below)
+        for (int r = 0; r <= 6; ++r) {
+            for (int dx = -r; dx <= r; ++dx) for (int dy = -r; dy <= r; ++dy) {
+                int tx = e.spawnTileX + dx; int ty = e.spawnTileY + dy;
+                if (!in_bounds(world, tx, ty)) continue;
+                if (get_block(world, tx, ty) == (char)AIR && isSolid(get_block(world, tx, ty+1))) {
+                    e.x = tx * TILE; e.y = ty * TILE; e.alive = true; e.hp = e.maxHp; e.vx = 0.0f; e.vy = 0.0f; e.fuseTimer = 0.0f; e.pauseTimer = 0.8f;
+                    placeEnemy(i);
+                    return;
+                }
+            }
+        }
+        // fallback: respawn at exact spawn tile
+        e.x = e.spawnTileX * TILE; e.y = e.spawnTileY * TILE; e.alive = true; e.hp = e.maxHp; e.vx = 0.0f; e.vy = 0.0f; e.fuseTimer = 0.0f; e.pauseTimer = 0.8f;
+        placeEnemy(i);
+    }
+
+    // tras un teletransporte: mover en la rejilla y no dibujarlo deslizándose desde donde murió
+    void placeEnemy(int i) {
+        const Enemy &e = enemies[i];
+        grid.update(i, e.x + e.w*0.5f, e.y + e.h*0.5f);
+        if ((std::size_t)i < enemyPrev.size()) enemyPrev[i] = sf::Vector2f(e.x, e.y);
+    }
+
+    void stepCombat(const SimInput &in) {
+        bool swordReady = p.holding(TOOL_SWORD);
+        // Sword hit detection while swingActive > 0
+        if (swingActive > 0.0f && swordReady) {
+            float attackX = (p.fx >= 0) ? (p.px + p.w) : (p.px - SWING_RANGE);
+            float attackY = p.py;
+            float attackW = SWING_RANGE;
+            float attackH = p.h;
+            hits.clear();
+            grid.query(attackX - ENTITY_MARGIN, attackY - ENTITY_MARGIN, attackX + attackW + ENTITY_MARGIN, attackY + attackH + ENTITY_MARGIN, [&](int id){
+                const Enemy &e = enemies[id];
+                if (e.alive && overlaps(attackX, attackY, attackW, attackH, e.x, e.y, e.w, e.h)) hits.push_back(id);
+            });
+            std::sort(hits.begin(), hits.end());
+            for (int id : hits) {
+                Enemy &e = enemies[id];
+                e.hp -= SWORD_DAMAGE;
+                // spawn hit sparks
+                spawnSparks(e.x + e.w*0.5f, e.y + e.h*0.5f, 6, 2.0f, 0.25f, 400.0f, 1.0f, 3, false);
+                if (e.hp <= 0) killEnemy(id);
+            }
+        }
+
+        // left-click attack trigger (edge): if pressed this tick and sword selected, trigger swing
+        if (in.mouseLeft && !prevMouseLeft && swordReady) {
+            if (swingTimer <= 0.0f) { swingTimer = SWING_COOLDOWN; swingActive = SWING_ACTIVE; }
+        }
+        prevMouseLeft = in.mouseLeft;
+    }
+
+    void stepHealth(float dt) {
+        // actualizar invulnerabilidad del jugador
+        if (playerInvuln > 0.0f) playerInvuln = std::max(0.0f, playerInvuln - dt);
+        // actualizar timers de regeneración
+        timeSinceDamage += dt;
+        if (timeSinceDamage >= REGEN_DELAY_AFTER_DAMAGE) {
+            regenTimer += dt;
+            if (regenTimer >= REGEN_INTERVAL) {
+                if (playerHealth < MAX_HEALTH) playerHealth++;
+                regenTimer = 0.0f;
+            }
+        } else {
+            regenTimer = 0.0f;
+        }
+
+        // Death / respawn
+        if (playerHealth <= 0) {
+            // respawn at initial spawn
+            p.px = spawnPx; p.py = spawnPy; p.vx = 0.0f; p.vy = 0.0f;
+            prevPx = p.px; prevPy = p.py;
+            playerHealth = MAX_HEALTH;
+            playerInvuln = 1.0f;
+            timeSinceDamage = REGEN_DELAY_AFTER_DAMAGE; // delay regen after death
+            resetFallTracking();
+        }
+    }
+
+    // Weather particles (spawn around the player, see WEATHER_AREA_W) and effect particles (sparks, explosion debris)
+    void stepParticles(float dt) {
+        float left = p.px + p.w*0.5f - WEATHER_AREA_W*0.5f; float top = p.py + p.h*0.5f - WEATHER_AREA_H*0.5f;
+        float bottom = top + WEATHER_AREA_H;
+        int spanX = (int)WEATHER_AREA_W;
+        if (weatherMode == WEATHER_RAIN) {
+            weatherSpawnAcc += dt * WEATHER_RAIN_SPAWN_PER_SEC * weatherIntensity;
+            while (weatherSpawnAcc >= 1.0f) {
+                weatherSpawnAcc -= 1.0f;
+                float x = left + weatherRng.below(spanX); float vy = 700.0f + weatherRng.below(300);
+                weatherParticles.spawn(x, top - 10.0f, 0.0f, vy, (bottom - top) / vy + 1.0f, 2.0f, sf::Color(160,200,255,200));
+            }
+        } else if (weatherMode == WEATHER_SNOW) {
+            weatherSpawnAcc += dt * WEATHER_SNOW_SPAWN_PER_SEC * weatherIntensity;
+            while (weatherSpawnAcc >= 1.0f) {
+                weatherSpawnAcc -= 1.0f;
+                float x = left + weatherRng.below(spanX); float vy = 60.0f + weatherRng.below(100);
+                weatherParticles.spawn(x, top - 10.0f, 0.0f, vy, (bottom - top) / vy + 2.0f, 4.0f, sf::Color(240,240,255,220));
+            }
+        }
+        weatherParticles.update(dt, 0.0f, bottom + 20.0f, jobs);
+        effectParticles.update(dt, EFFECT_GRAVITY, std::numeric_limits<float>::max(), jobs);
+    }
+};
@@ -0,0 +1,130 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Rejilla uniforme para encontrar entidades cercanas sin recorrer todas.
+// Cada entidad (un id 0..N-1) se guarda en la celda de su punto central; quien consulta amplía
+// el rectángulo con el medio tamaño de las entidades y hace después la prueba exacta.
+// Mover una entidad solo toca la rejilla cuando cambia de celda.
+// Las celdas están en una tabla de direccionamiento abierto (potencia de 2, sondeo lineal): una consulta
+// pequeña mira unas pocas celdas y cada búsqueda es una multiplicación y, normalmente, una comparación.
+// Las celdas vacías no se borran; la tabla crece con el área recorrida, no con el tiempo.
+class SpatialHash {
+public:
+    explicit SpatialHash(float cellSize) : cell(cellSize) {}
+
+    std::size_t size() const { return cellOf.size(); }
+
+    void clear() { keys.clear(); lists.clear(); used = 0; cellOf.clear(); }
+
+    // Los ids se asignan en orden: insert(id) con id == size()
+    void insert(int id, float x, float y) {
+        if ((std::size_t)id >= cellOf.size()) cellOf.resize((std::size_t)id + 1, NO_CELL);
+        std::int64_t k = key(x, y);
+        cellOf[id] = k;
+        list(k).push_back(id);
+    }
+
+    void update(int id, float x, float y) {
+        std::int64_t k = key(x, y);
+        std::int64_t old = cellOf[id];
+        if (k == old) return;
+        removeFrom(old, id);
+        cellOf[id] = k;
+        list(k).push_back(id);
+    }
+
+    // Llama f(id) para cada entidad cuya celda toca el rectángulo [x0,x1] x [y0,y1]
+    template <class F>
+    void query(float x0, float y0, float x1, float y1, F &&f) const {
+        int cx0 = coord(x0), cy0 = coord(y0), cx1 = coord(x1), cy1 = coord(y1);
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                const std::vector<int> *v = find(pack(cx, cy));
+                if (!v) continue;
+                for (int id : *v) f(id);
+            }
+        }
+    }
+
+    // Primer id del rectángulo que cumple pred (o -1); deja de buscar en cuanto lo encuentra
+    template <class P>
+    int findFirst(float x0, float y0, float x1, float y1, P &&pred) const {
+        int cx0 = coord(x0), cy0 = coord(y0), cx1 = coord(x1), cy1 = coord(y1);
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                const std::vector<int> *v = find(pack(cx, cy));
+                if (!v) continue;
+                for (int id : *v) if (pred(id)) return id;
+            }
+        }
+        return -1;
+    }
+
+private:
+    static constexpr std::int64_t NO_CELL = INT64_MIN;
+    static constexpr std::size_t NO_SLOT = SIZE_MAX;
+
+    int coord(float v) const { return (int)std::floor(v / cell); }
+    static std::int64_t pack(int cx, int cy) { return (std::int64_t)((std::uint64_t)(std::uint32_t)cx << 32 | (std::uint32_t)cy); }
+    std::int64_t key(float x, float y) const { return pack(coord(x), coord(y)); }
+
+    static std::size_t hash(std::int64_t k) { return (std::size_t)(((std::uint64_t)k * 0x9E3779B97F4A7C15ull) >> 32); }
+
+    // Hueco de la celda k, o NO_SLOT si no existe
+    std::size_t slot(std::int64_t k) const {
+        if (keys.empty()) return NO_SLOT;
+        std::size_t mask = keys.size() - 1;
+        for (std::size_t h = hash(k) & mask;; h = (h + 1) & mask) {
+            if (keys[h] == k) return h;
+            if (keys[h] == NO_CELL) return NO_SLOT;
+        }
+    }
+
+    const std::vector<int> *find(std::int64_t k) const {
+        std::size_t h = slot(k);
+        return h == NO_SLOT ? nullptr : &lists[h];
+    }
+
+    // Lista de la celda k, creándola si no existe
+    std::vector<int> &list(std::int64_t k) {
+        if ((used + 1) * 2 > keys.size()) grow();
+        std::size_t mask = keys.size() - 1;
+        std::size_t h = hash(k) & mask;
+        while (keys[h] != k && keys[h] != NO_CELL) h = (h + 1) & mask;
+        if (keys[h] == NO_CELL) { keys[h] = k; ++used; }
+        return lists[h];
+    }
+
+    void grow() {
+        std::vector<std::int64_t> oldKeys(std::max<std::size_t>(64, keys.size() * 2), NO_CELL);
+        std::vector<std::vector<int>> oldLists(oldKeys.size());
+        oldKeys.swap(keys); oldLists.swap(lists);
+        std::size_t mask = keys.size() - 1;
+        for (std::size_t i = 0; i < oldKeys.size(); ++i) {
+            if (oldKeys[i] == NO_CELL) continue;
+            std::size_t h = hash(oldKeys[i]) & mask;
+            while (keys[h] != NO_CELL) h = (h + 1) & mask;
+            keys[h] = oldKeys[i];
+            lists[h] = std::move(oldLists[i]);
+        }
+    }
+
+    void removeFrom(std::int64_t k, int id) {
+        std::size_t h = slot(k);
+        if (h == NO_SLOT) return;
+        std::vector<int> &v = lists[h];
+        for (std::size_t i = 0; i < v.size(); ++i) {
+            if (v[i] == id) { v[i] = v.back(); v.pop_back(); break; }
+        }
+    }
+
+    float cell;
+    std::vector<std::int64_t> keys;       // clave de cada hueco (NO_CELL = libre)
+    std::vector<std::vector<int>> lists;  // ids de cada celda
+    std::size_t used = 0;
+    std::vector<std::int64_t> cellOf; // celda actual de cada id
+};
@@ -0,0 +1,107 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Todas las imágenes de una carpeta empaquetadas en una sola textura (por filas, de la más alta a la
+// más baja). Cada imagen se identifica con un SpriteId entero que se resuelve una vez al cargar;
+// al dibujar solo se usan ids, sin buscar nombres ni cambiar de textura.
+// La casilla white() es un píxel blanco para dibujar rectángulos de color con la misma textura.
+// Las imágenes se decodifican fuera (AssetLoader); build() solo las copia y sube la textura, en el hilo de la ventana.
+using SpriteId = int;
+const SpriteId NO_SPRITE = -1;
+
+class SpriteAtlas {
+public:
+    SpriteAtlas() { rects.push_back(sf::IntRect(0, 0, WHITE_SIZE, WHITE_SIZE)); } // sin textura aún: white() pinta el color liso
+
+    // Empaqueta las imágenes; las que no caben en la textura máxima se descartan con un aviso
+    bool build(std::vector<std::pair<std::string, sf::Image>> &images) {
+        ids.clear(); rects.clear();
+        std::sort(images.begin(), images.end(), [](const auto &a, const auto &b){ return a.second.getSize().y > b.second.getSize().y; });
+        const unsigned maxSize = sf::Texture::getMaximumSize();
+        const unsigned width = std::min(maxSize, ATLAS_WIDTH);
+        // casilla blanca primero, luego las imágenes por filas con PADDING píxeles de separación
+        rects.push_back(sf::IntRect(0, 0, WHITE_SIZE, WHITE_SIZE));
+        unsigned x = WHITE_SIZE + PADDING, y = 0, rowH = WHITE_SIZE, height = WHITE_SIZE;
+        std::vector<const sf::Image*> placed;
+        placed.push_back(nullptr);
+        for (auto &im : images) {
+            sf::Vector2u s = im.second.getSize();
+            if (s.x == 0 || s.y == 0) continue;
+            if (x + s.x > width) { x = 0; y += rowH + PADDING; rowH = 0; }
+            if (s.x > width || y + s.y > maxSize) { std::cerr << "Aviso: " << im.first << " no cabe en el atlas" << std::endl; continue; }
+            ids[im.first] = (SpriteId)rects.size();
+            rects.push_back(sf::IntRect((int)x, (int)y, (int)s.x, (int)s.y));
+            placed.push_back(&im.second);
+            x += s.x + PADDING;
+            rowH = std::max(rowH, s.y);
+            height = std::max(height, y + s.y);
+        }
+        sf::Image sheet;
+        sheet.create(width, height, sf::Color::Transparent);
+        for (int y0 = 0; y0 < WHITE_SIZE; ++y0) for (int x0 = 0; x0 < WHITE_SIZE; ++x0) sheet.setPixel(x0, y0, sf::Color::White);
+        for (std::size_t i = 1; i < rects.size(); ++i) sheet.copy(*placed[i], rects[i].left, rects[i].top);
+        return tex.loadFromImage(sheet);
+    }
+
+    // Id de la primera clave que exista (p. ej. {"spider", "araña", "arana"}), o NO_SPRITE
+    SpriteId find(std::initializer_list<const char*> keys) const {
+        for (const char *k : keys) {
+            auto it = ids.find(k);
+            if (it != ids.end()) return it->second;
+        }
+        return NO_SPRITE;
+    }
+
+    SpriteId white() const { return WHITE; }
+    const sf::IntRect &rect(SpriteId id) const { return rects[id]; }
+    const sf::Texture &texture() const { return tex; }
+
+private:
+    static constexpr SpriteId WHITE = 0;
+    static constexpr int WHITE_SIZE = 2;
+    static constexpr unsigned PADDING = 1; // evita que el muestreo coja píxeles de la imagen vecina
+    static constexpr unsigned ATLAS_WIDTH = 2048;
+
+    std::unordered_map<std::string, SpriteId> ids;
+    std::vector<sf::IntRect> rects;
+    sf::Texture tex;
+};
+
+// Quads de sprites del mismo atlas acumulados en un VertexArray y dibujados con una sola llamada
+class SpriteBatch {
+public:
+    explicit SpriteBatch(const SpriteAtlas &atlas) : atlas(atlas) {}
+
+    void clear() { va.clear(); }
+
+    // Sprite 'id' estirado al rectángulo (pos, size) y teñido con color
+    void add(SpriteId id, sf::Vector2f pos, sf::Vector2f size, sf::Color color) {
+        const sf::IntRect &r = atlas.rect(id);
+        float u0 = (float)r.left, v0 = (float)r.top, u1 = u0 + r.width, v1 = v0 + r.height;
+        if (id == atlas.white()) { u0 += 0.5f; v0 += 0.5f; u1 = v1 = 1.5f; } // centro de la casilla, sin bordes
+        float x1 = pos.x + size.x, y1 = pos.y + size.y;
+        va.append(sf::Vertex(pos, color, sf::Vector2f(u0, v0)));
+        va.append(sf::Vertex(sf::Vector2f(x1, pos.y), color, sf::Vector2f(u1, v0)));
+        va.append(sf::Vertex(sf::Vector2f(x1, y1), color, sf::Vector2f(u1, v1)));
+        va.append(sf::Vertex(sf::Vector2f(pos.x, y1), color, sf::Vector2f(u0, v1)));
+    }
+
+    // Rectángulo de color liso (la casilla blanca teñida)
+    void addRect(sf::Vector2f pos, sf::Vector2f size, sf::Color color) { add(atlas.white(), pos, size, color); }
+
+    void draw(sf::RenderTarget &target) const {
+        if (va.getVertexCount() == 0) return;
+        target.draw(va, sf::RenderStates(&atlas.texture()));
+    }
+
+private:
+    const SpriteAtlas &atlas;
+    sf::VertexArray va{sf::Quads};
+};
@@ -0,0 +1,110 @@
+#pragma once
+#include <chipmunk/chipmunk.h>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "World.hpp"
+
+// Rectángulo de tiles sólidos dentro de un chunk (en tiles, relativo a su esquina)
+struct TileBox {
+    std::uint8_t x, y, w, h;
+};
+
+// Cubre los tiles sólidos del chunk con pocos rectángulos: fila a fila, cada tramo sólido aún sin cubrir se
+// alarga hacia abajo mientras la fila siguiente tenga ese mismo tramo entero sólido y libre. Un chunk de
+// terreno macizo queda en un puñado de cajas en vez de cientos de tiles.
+inline void merge_solid_tiles(const Chunk &c, std::vector<TileBox> &out) {
+    static_assert(CHUNK_SIZE <= 32, "merge_solid_tiles usa una palabra de 32 bits por fila");
+    out.clear();
+    std::uint32_t solid[CHUNK_SIZE] = {}, used[CHUNK_SIZE] = {}; // un bit por tile, una palabra por fila
+    for (int y = 0; y < CHUNK_SIZE; ++y)
+        for (int x = 0; x < CHUNK_SIZE; ++x)
+            if (BLOCKS[c.get(x, y)].solid) solid[y] |= 1u << x;
+    for (int y = 0; y < CHUNK_SIZE; ++y) {
+        for (int x = 0; x < CHUNK_SIZE;) {
+            const std::uint32_t open = solid[y] & ~used[y];
+            if (!(open >> x & 1u)) { ++x; continue; }
+            int w = 1;
+            while (x + w < CHUNK_SIZE && (open >> (x + w) & 1u)) ++w;
+            const std::uint32_t run = (w == 32 ? ~0u : ((1u << w) - 1u)) << x;
+            int h = 1;
+            while (y + h < CHUNK_SIZE && (solid[y + h] & ~used[y + h] & run) == run) ++h;
+            for (int k = 0; k < h; ++k) used[y + k] |= run;
+            out.push_back({(std::uint8_t)x, (std::uint8_t)y, (std::uint8_t)w, (std::uint8_t)h});
+            x += w;
+        }
+    }
+}
+
+// Terreno del mundo como formas estáticas de Chipmunk, para que los cuerpos rígidos (pelotas, restos...)
+// choquen con los tiles. Cada chunk es un grupo de cajas (merge_solid_tiles); solo se rehacen los chunks
+// con CHUNK_DIRTY_PHYSICS (World::set, columnas recién cargadas) y se quitan los de columnas descargadas.
+class TileColliders {
+public:
+    explicit TileColliders(cpSpace *space, float tileSize = (float)TILE) : space(space), tile(tileSize) {}
+
+    ~TileColliders() {
+        for (auto &kv : chunks) clear(kv.second);
+    }
+
+    // Llamar una vez por frame, antes de avanzar el espacio
+    void update(World &world) {
+        auto t0 = std::chrono::steady_clock::now();
+        rebuilt = 0;
+        // fuera lo de los chunks que ya no están (columna descargada o chunk sustituido)
+        for (auto it = chunks.begin(); it != chunks.end();) {
+            if (world.chunkAt(it->second.cx, it->second.cy) == it->second.src) { ++it; continue; }
+            clear(it->second);
+            it = chunks.erase(it);
+        }
+        world.forEachChunk([&](Chunk &c){
+            if (!(c.dirty & CHUNK_DIRTY_PHYSICS)) return;
+            c.dirty &= (std::uint8_t)~CHUNK_DIRTY_PHYSICS;
+            Entry &e = chunks[key(c.cx, c.cy)];
+            clear(e);
+            e.src = &c; e.cx = c.cx; e.cy = c.cy;
+            merge_solid_tiles(c, boxes);
+            const cpFloat x0 = (cpFloat)(c.cx * CHUNK_SIZE) * tile, y0 = (cpFloat)(c.cy * CHUNK_SIZE) * tile;
+            cpBody *ground = cpSpaceGetStaticBody(space);
+            for (const TileBox &b : boxes) {
+                cpBB bb = cpBBNew(x0 + b.x * tile, y0 + b.y * tile, x0 + (b.x + b.w) * tile, y0 + (b.y + b.h) * tile);
+                cpShape *shape = cpBoxShapeNew2(ground, bb, 0.0);
+                cpShapeSetFriction(shape, 1.0);
+                cpSpaceAddShape(space, shape);
+                e.shapes.push_back(shape);
+            }
+            shapes += e.shapes.size();
+            ++rebuilt;
+        });
+        lastUpdateNs = (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    std::size_t shapeCount() const { return shapes; }
+    std::size_t chunkCount() const { return chunks.size(); }
+    int lastRebuilt() const { return rebuilt; }            // chunks rehechos en el último update
+    std::uint64_t lastUpdateTimeNs() const { return lastUpdateNs; }
+
+private:
+    struct Entry {
+        const Chunk *src = nullptr;
+        int cx = 0, cy = 0;
+        std::vector<cpShape *> shapes;
+    };
+
+    static std::uint64_t key(int cx, int cy) { return (std::uint64_t)(std::uint32_t)cx << 32 | (std::uint32_t)cy; }
+
+    void clear(Entry &e) {
+        for (cpShape *s : e.shapes) { cpSpaceRemoveShape(space, s); cpShapeFree(s); }
+        shapes -= e.shapes.size();
+        e.shapes.clear();
+    }
+
+    cpSpace *space;
+    cpFloat tile;
+    std::unordered_map<std::uint64_t, Entry> chunks;
+    std::vector<TileBox> boxes;
+    std::size_t shapes = 0;
+    int rebuilt = 0;
+    std::uint64_t lastUpdateNs = 0;
+};
@@ -0,0 +1,230 @@
+#pragma once
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Block.hpp"
+
+// Mundo dividido en chunks de CHUNK_SIZE x CHUNK_SIZE tiles.
+// En horizontal es ilimitado: se guardan columnas de chunks (toda la altura del mundo) en un anillo
+// indexado por cx & (capacidad-1); solo las columnas cargadas ocupan memoria.
+// Dentro de una columna, los chunks que son todo aire no se reservan.
+const int CHUNK_SHIFT = 5;
+const int CHUNK_SIZE = 1 << CHUNK_SHIFT; // 32x32 tiles
+const int CHUNK_MASK = CHUNK_SIZE - 1;
+const int CHUNK_AREA = CHUNK_SIZE * CHUNK_SIZE;
+// Lado de un tile en píxeles (física y render)
+const int TILE = 32;
+
+// Luz de un tile: nivel de cielo en el nibble alto y de bloques (lava, ...) en el bajo, 0..15 cada uno
+const int LIGHT_MAX = 15;
+inline int sky_light(std::uint8_t l) { return l >> 4; }
+inline int block_light(std::uint8_t l) { return l & 15; }
+
+// Cantidad de fluido de un tile de fluido (lava): 1..FLUID_MAX
+const int FLUID_MAX = 8;
+
+// Bits de "sucio" por chunk: cada subsistema (render, guardado, ...) limpia el suyo
+enum ChunkDirty : std::uint8_t { CHUNK_DIRTY_MESH = 1, CHUNK_DIRTY_SAVE = 2, CHUNK_DIRTY_NET = 4, CHUNK_DIRTY_PHYSICS = 8, CHUNK_DIRTY_ALL = 0xFF };
+
+struct Chunk {
+    int cx, cy;          // coordenadas del chunk (en chunks, no en tiles)
+    std::uint8_t dirty;  // máscara de ChunkDirty
+    std::array<BlockId, CHUNK_AREA> blocks;
+
+    Chunk(int cx_, int cy_, BlockId fill) : cx(cx_), cy(cy_), dirty(CHUNK_DIRTY_ALL) { blocks.fill(fill); }
+
+    BlockId get(int lx, int ly) const { return blocks[(ly << CHUNK_SHIFT) | lx]; }
+};
+
+class World {
+public:
+    World() {}
+
+    World(int height, int maxColumns) {
+        reset(height, maxColumns);
+    }
+
+    // Descarta todo el contenido. maxColumns es cuántas columnas pueden estar cargadas a la vez.
+    void reset(int height, int maxColumns) {
+        h = height;
+        ch = (height + CHUNK_MASK) >> CHUNK_SHIFT;
+        int cap = 1;
+        while (cap < maxColumns) cap <<= 1;
+        mask = cap - 1;
+        columns.clear();
+        columns.resize(cap);
+        for (auto &col : columns) col.chunks.resize(ch);
+        lightEdits.clear();
+        unlitColumns.clear();
+        fluidEdits.clear();
+        fallEdits.clear();
+    }
+
+    int height() const { return h; }
+    int chunksY() const { return ch; }
+    int capacity() const { return mask + 1; }
+
+    bool isColumnLoaded(int cx) const { return columns[cx & mask].cx == cx; }
+    // insertColumn(cx) no fallaría: el hueco del anillo está libre o ya es de cx
+    bool isColumnSlotFree(int cx) const { return columns[cx & mask].cx == cx || columns[cx & mask].cx == NO_COLUMN; }
+
+    // dentro de la altura del mundo y en una columna cargada
+    bool inBounds(int x, int y) const { return y >= 0 && y < h && isColumnLoaded(x >> CHUNK_SHIFT); }
+
+    // Acceso sin comprobar límites: el llamador garantiza inBounds(x, y)
+    BlockId get(int x, int y) const {
+        const Chunk* c = columns[(x >> CHUNK_SHIFT) & mask].chunks[y >> CHUNK_SHIFT].get();
+        return c ? c->get(x & CHUNK_MASK, y & CHUNK_MASK) : (BlockId)AIR;
+    }
+
+    void set(int x, int y, BlockId b) {
+        Column &col = columns[(x >> CHUNK_SHIFT) & mask];
+        std::unique_ptr<Chunk> &slot = col.chunks[y >> CHUNK_SHIFT];
+        if (!slot) {
+            if (b == (BlockId)AIR) return; // un chunk sin reservar ya es aire
+            slot.reset(new Chunk(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, (BlockId)AIR));
+        }
+        BlockId &cell = slot->blocks[((y & CHUNK_MASK) << CHUNK_SHIFT) | (x & CHUNK_MASK)];
+        if (cell == b) return;
+        const BlockInfo &before = BLOCKS[cell], &after = BLOCKS[b];
+        if (before.light != after.light || before.opacity != after.opacity) lightEdits.push_back({x, y});
+        if (before.solid != after.solid) ++solidRevision;
+        if (before.solid != after.solid || before.flow || after.flow) fluidEdits.push_back({x, y});
+        if (before.solid != after.solid || after.falls) fallEdits.push_back({x, y});
+        cell = b;
+        col.fluidMissing[(y << CHUNK_SHIFT) | (x & CHUNK_MASK)] = 0; // un bloque nuevo empieza lleno
+        slot->dirty = CHUNK_DIRTY_ALL;
+    }
+
+    // Nivel de fluido (1..FLUID_MAX) de un tile de fluido; mismas condiciones que get()
+    int fluidLevel(int x, int y) const { return FLUID_MAX - columns[(x >> CHUNK_SHIFT) & mask].fluidMissing[(y << CHUNK_SHIFT) | (x & CHUNK_MASK)]; }
+
+    void setFluidLevel(int x, int y, int level) {
+        std::uint8_t &cell = columns[(x >> CHUNK_SHIFT) & mask].fluidMissing[(y << CHUNK_SHIFT) | (x & CHUNK_MASK)];
+        if (cell == FLUID_MAX - level) return;
+        cell = (std::uint8_t)(FLUID_MAX - level);
+        // el nivel se guarda con el chunk (RegionStore)
+        if (Chunk *c = chunkAt(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT)) c->dirty |= CHUNK_DIRTY_MESH | CHUNK_DIRTY_SAVE;
+    }
+
+    // Luz del tile (ver sky_light/block_light); mismas condiciones que get()
+    std::uint8_t light(int x, int y) const { return columns[(x >> CHUNK_SHIFT) & mask].light[(y << CHUNK_SHIFT) | (x & CHUNK_MASK)]; }
+
+    // Cambia la luz de un tile y marca para remallar los chunks cuyos vértices la usan
+    void setLight(int x, int y, std::uint8_t l) {
+        Column &col = columns[(x >> CHUNK_SHIFT) & mask];
+        std::uint8_t &cell = col.light[(y << CHUNK_SHIFT) | (x & CHUNK_MASK)];
+        if (cell == l) return;
+        cell = l;
+        int lx = x & CHUNK_MASK, ly = y & CHUNK_MASK;
+        markMesh(x >> CHUNK_SHIFT, y >> CHUNK_SHIFT);
+        // un vértice en el borde del chunk también promedia este tile
+        if (lx == 0) markMesh((x >> CHUNK_SHIFT) - 1, y >> CHUNK_SHIFT);
+        if (lx == CHUNK_MASK) markMesh((x >> CHUNK_SHIFT) + 1, y >> CHUNK_SHIFT);
+        if (ly == 0) markMesh(x >> CHUNK_SHIFT, (y >> CHUNK_SHIFT) - 1);
+        if (ly == CHUNK_MASK) markMesh(x >> CHUNK_SHIFT, (y >> CHUNK_SHIFT) + 1);
+    }
+
+    // nullptr si la columna no está cargada, cy está fuera o el chunk es todo aire
+    Chunk* chunkAt(int cx, int cy) {
+        if (cy < 0 || cy >= ch || !isColumnLoaded(cx)) return nullptr;
+        return columns[cx & mask].chunks[cy].get();
+    }
+
+    const Chunk* chunkAt(int cx, int cy) const {
+        if (cy < 0 || cy >= ch || !isColumnLoaded(cx)) return nullptr;
+        return columns[cx & mask].chunks[cy].get();
+    }
+
+    // Instala una columna generada (un puntero por cy). Falla si su hueco del anillo
+    // está ocupado por otra columna cargada: hay que descargar esa primero.
+    bool insertColumn(int cx, std::vector<std::unique_ptr<Chunk>> &chunks) {
+        Column &col = columns[cx & mask];
+        if (col.cx != cx && col.cx != NO_COLUMN) return false;
+        col.cx = cx;
+        for (int cy = 0; cy < ch; ++cy) col.chunks[cy] = (cy < (int)chunks.size()) ? std::move(chunks[cy]) : nullptr;
+        col.light.assign((std::size_t)ch * CHUNK_AREA, 0);
+        col.fluidMissing.assign((std::size_t)ch * CHUNK_AREA, 0);
+        unlitColumns.push_back(cx);
+        ++solidRevision;
+        return true;
+    }
+
+    // Sustituye un chunk de una columna cargada (p. ej. por la versión guardada en disco)
+    void setChunk(int cx, int cy, std::unique_ptr<Chunk> c) {
+        if (cy < 0 || cy >= ch || !isColumnLoaded(cx)) return;
+        columns[cx & mask].chunks[cy] = std::move(c);
+        ++solidRevision;
+    }
+
+    void unloadColumn(int cx) {
+        Column &col = columns[cx & mask];
+        if (col.cx != cx) return;
+        col.cx = NO_COLUMN;
+        for (auto &c : col.chunks) c.reset();
+        col.light.clear();
+        col.fluidMissing.clear();
+        ++solidRevision;
+    }
+
+    // f(cx) para cada columna cargada
+    template <class F>
+    void forEachColumn(F f) const {
+        for (auto &col : columns) if (col.cx != NO_COLUMN) f(col.cx);
+    }
+
+    // Recorre los chunks reservados (unidad de trabajo para render, luz y guardado)
+    template <class F>
+    void forEachChunk(F f) {
+        for (auto &col : columns) {
+            if (col.cx == NO_COLUMN) continue;
+            for (auto &c : col.chunks) if (c) f(*c);
+        }
+    }
+
+    std::size_t loadedChunks() const {
+        std::size_t n = 0;
+        for (auto &col : columns) {
+            if (col.cx == NO_COLUMN) continue;
+            for (auto &c : col.chunks) if (c) ++n;
+        }
+        return n;
+    }
+
+    // Trabajo pendiente para LightEngine (lo vacía en cada actualización)
+    std::vector<std::pair<int, int>> lightEdits; // tiles cuyo cambio de bloque altera la luz
+    std::vector<int> unlitColumns;               // columnas instaladas aún sin iluminar
+    // Trabajo pendiente para FluidSim: tiles cuyo cambio puede poner fluidos en marcha
+    std::vector<std::pair<int, int>> fluidEdits;
+    // Trabajo pendiente para FallingBlocks: tiles que pierden o ganan apoyo, o bloques que caen recién puestos
+    std::vector<std::pair<int, int>> fallEdits;
+    // Sube cada vez que cambia qué tiles son sólidos (para cachés de caminos y similares)
+    std::uint32_t solidRevision = 0;
+
+private:
+    static const int NO_COLUMN = INT_MIN;
+
+    struct Column {
+        int cx = NO_COLUMN;
+        std::vector<std::unique_ptr<Chunk>> chunks; // una entrada por cy
+        std::vector<std::uint8_t> light;            // CHUNK_SIZE x altura, fila a fila; existe aunque el chunk sea aire
+        std::vector<std::uint8_t> fluidMissing;     // igual; FLUID_MAX - nivel, así lo generado o cargado empieza lleno
+    };
+
+    void markMesh(int cx, int cy) {
+        if (Chunk *c = chunkAt(cx, cy)) c->dirty |= CHUNK_DIRTY_MESH;
+    }
+
+    int h = 0;    // altura en tiles
+    int ch = 0;   // altura en chunks
+    int mask = 0; // capacidad del anillo - 1 (potencia de dos)
+    std::vector<Column> columns;
+};
+
+inline bool in_bounds(const World &w, int x, int y) { return w.inBounds(x, y); }
+// fuera del mundo, o en una columna que aún no se ha generado, se comporta como roca madre
+inline char get_block(const World &w, int x, int y) { if (!w.inBounds(x, y)) return (char)BEDR; return (char)w.get(x, y); }
+inline void set_block(World &w, int x, int y, char b) { if (w.inBounds(x, y)) w.set(x, y, (BlockId)b); }
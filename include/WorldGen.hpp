@@ -0,0 +1,245 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <memory>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include "World.hpp"
+
+// Generación procedural por columnas de chunks (CHUNK_SIZE tiles de ancho x altura del mundo).
+// La generación se divide en pasadas explícitas y cada una saca su azar de gen_rand(semilla, pasada, x, y),
+// un PRNG basado en contador: el resultado solo depende de la semilla y la posición, así que las columnas
+// se pueden generar en cualquier orden y en cualquier número de hilos con salida idéntica bit a bit.
+
+const int BIOME_PERIOD = 240;   // desierto / normal / nieve se repiten cada BIOME_PERIOD columnas
+const int TUNNEL_SEGMENT = 240; // cada segmento de columnas siembra su propio grupo de túneles
+const int TUNNEL_MAX_LEN = 160;
+const int TUNNEL_REACH = TUNNEL_MAX_LEN * 2 + 2; // desplazamiento horizontal máximo de un túnel
+const int TREE_REACH = 2;                        // la copa se extiende 2 tiles a cada lado del tronco
+
+enum GenPass { PASS_HEIGHT = 0, PASS_SURFACE, PASS_NETHER, PASS_TREES, PASS_CAVES, PASS_ORES, PASS_COUNT };
+static const char* const GEN_PASS_NAMES[PASS_COUNT] = { "heightmap", "surface", "nether", "trees", "caves", "ores" };
+
+inline std::uint32_t gen_rand(std::uint32_t seed, GenPass pass, int x, int y) {
+    std::uint64_t h = ((std::uint64_t)(std::uint32_t)x << 32) | (std::uint32_t)y;
+    h ^= ((std::uint64_t)seed << 17) ^ ((std::uint64_t)(pass + 1) * 0x9E3779B97F4A7C15ULL);
+    // finalizador de splitmix64
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return (std::uint32_t)h;
+}
+
+inline int floor_div(int a, int b) { return (a >= 0) ? a / b : -((-a + b - 1) / b); }
+
+inline int gen_region(int x) {
+    int m = x - floor_div(x, BIOME_PERIOD) * BIOME_PERIOD;
+    return (m * 3) / BIOME_PERIOD; // 0 = desierto, 1 = normal, 2 = nieve
+}
+
+// altura de la superficie (primer tile sólido) de la columna x
+inline int gen_surface(std::uint32_t seed, int H, int x) {
+    float t = (float)x / (float)BIOME_PERIOD * 6.2831853f; // 2*pi
+    float base = (std::sin(t * 0.7f) + 1.0f) * 0.5f; // 0..1
+    int h = (int)((H / 3) + base * (H / 6)) + (int)(gen_rand(seed, PASS_HEIGHT, x, 0) % 3) - 1;
+    return std::max(2, std::min(H-6, h));
+}
+
+// Tiempo acumulado por pasada; compartido por todos los hilos de generación
+struct GenStats {
+    std::atomic<std::uint64_t> passNs[PASS_COUNT];
+    std::atomic<std::uint64_t> columns;
+
+    GenStats() : columns(0) { for (auto &p : passNs) p = 0; }
+};
+
+// Buffer de una columna de chunks en coordenadas de mundo; las escrituras fuera se ignoran
+struct GenColumn {
+    int x0, H;
+    std::vector<BlockId> cells;
+    int heights[CHUNK_SIZE + 2 * TREE_REACH]; // alturas de x0-TREE_REACH .. x0+CHUNK_SIZE+TREE_REACH-1
+
+    GenColumn(int cx, int height) : x0(cx * CHUNK_SIZE), H(height), cells((std::size_t)CHUNK_SIZE * height, (BlockId)AIR) {}
+
+    bool contains(int x, int y) const { return x >= x0 && x < x0 + CHUNK_SIZE && y >= 0 && y < H; }
+    BlockId get(int x, int y) const { return cells[(std::size_t)y * CHUNK_SIZE + (x - x0)]; }
+    void set(int x, int y, BlockId b) { if (contains(x, y)) cells[(std::size_t)y * CHUNK_SIZE + (x - x0)] = b; }
+    int surface(int x) const { return heights[x - x0 + TREE_REACH]; }
+};
+
+inline void pass_heightmap(std::uint32_t seed, GenColumn &col) {
+    for (int i = 0; i < CHUNK_SIZE + 2 * TREE_REACH; ++i) col.heights[i] = gen_surface(seed, col.H, col.x0 - TREE_REACH + i);
+}
+
+// suelo según alturas, con biomas: desierto / normal / nieve, y roca madre al fondo
+inline void pass_surface(std::uint32_t, GenColumn &col) {
+    const int H = col.H;
+    for (int x = col.x0; x < col.x0 + CHUNK_SIZE; ++x) {
+        int g = col.surface(x);
+        int region = gen_region(x);
+        for (int y = g; y < H-1; ++y) {
+            if (y == g) col.set(x, y, region == 0 ? (BlockId)SAND : (region == 2 ? (BlockId)SNOW : (BlockId)GRASS));
+            else if (y < g + 4) col.set(x, y, region == 0 ? (BlockId)SAND : (BlockId)DIRT);
+            else col.set(x, y, STONE);
+        }
+        col.set(x, H-1, BEDR);
+    }
+}
+
+// Infierno (nether): capas de NETH con bolsas de LAVA encima de la roca profunda
+inline void pass_nether(std::uint32_t seed, GenColumn &col) {
+    const int H = col.H;
+    int nethDepth = std::max(6, H/12);
+    for (int y = H-1 - nethDepth; y < H-1; ++y) {
+        for (int x = col.x0; x < col.x0 + CHUNK_SIZE; ++x) {
+            if ((gen_rand(seed, PASS_NETHER, x, y) % 100) < 40 && y >= H-2) col.set(x, y, LAVA);
+            else col.set(x, y, NETH);
+        }
+    }
+}
+
+// árboles: también los de columnas vecinas, cuya copa puede entrar en este chunk
+inline void pass_trees(std::uint32_t seed, GenColumn &col) {
+    for (int x = col.x0 - TREE_REACH; x < col.x0 + CHUNK_SIZE + TREE_REACH; ++x) {
+        int region = gen_region(x);
+        if (region == 0) continue; // sin árboles en el desierto
+        int treeChance = (region == 2) ? 18 : 12;
+        if ((int)(gen_rand(seed, PASS_TREES, x, 0) % 100) >= treeChance) continue;
+        int g = col.surface(x);
+        int trunkH = 2 + (int)(gen_rand(seed, PASS_TREES, x, 1) % 3); // 2..4
+        for (int t = 1; t <= trunkH; ++t) col.set(x, g - t, WOOD);
+        int topY = g - trunkH;
+        for (int dx = -TREE_REACH; dx <= TREE_REACH; ++dx) for (int dy = -2; dy <= 0; ++dy) {
+            int xx = x + dx; int yy = topY + dy;
+            if (col.contains(xx, yy) && col.get(xx, yy) == (BlockId)AIR) col.set(xx, yy, region == 2 ? (BlockId)SNOW : (BlockId)LEAF);
+        }
+    }
+}
+
+// túneles: paseos aleatorios sembrados por segmento; se simulan los de todos los segmentos
+// que pueden alcanzar esta columna y solo se cava lo que cae dentro
+inline void pass_caves(std::uint32_t seed, GenColumn &col) {
+    const int H = col.H;
+    int firstSeg = floor_div(col.x0 - TUNNEL_REACH - TUNNEL_SEGMENT, TUNNEL_SEGMENT);
+    int lastSeg = floor_div(col.x0 + CHUNK_SIZE + TUNNEL_REACH, TUNNEL_SEGMENT);
+    for (int seg = firstSeg; seg <= lastSeg; ++seg) {
+        int tunnels = 6 + (int)(gen_rand(seed, PASS_CAVES, seg, -1) % 6);
+        for (int i = 0; i < tunnels; ++i) {
+            int id = seg * 16 + i;
+            int tx = seg * TUNNEL_SEGMENT + (int)(gen_rand(seed, PASS_CAVES, id, -2) % TUNNEL_SEGMENT);
+            // comenzar más profundo para no afectar la capa de superficie
+            int ty = std::min(H-6, gen_surface(seed, H, tx) + 8 + (int)(gen_rand(seed, PASS_CAVES, id, -3) % 6));
+            int len = 40 + (int)(gen_rand(seed, PASS_CAVES, id, -4) % (TUNNEL_MAX_LEN - 40));
+            for (int s = 0; s < len; ++s) {
+                std::uint32_t r = gen_rand(seed, PASS_CAVES, id, s);
+                int radius = (int)(r % 3);
+                if (tx + radius >= col.x0 && tx - radius < col.x0 + CHUNK_SIZE) {
+                    int top = gen_surface(seed, H, tx) + 2;
+                    for (int dy = -radius; dy <= radius; ++dy) for (int dx = -radius; dx <= radius; ++dx) {
+                        int xx = tx + dx; int yy = ty + dy;
+                        // no cavar en la capa superior cercana (proteger altura de columna)
+                        if (col.contains(xx, yy) && yy < H-2 && yy > top) col.set(xx, yy, AIR);
+                    }
+                }
+                // random walk con variación vertical
+                tx += (int)((r >> 8) % 5) - 2;
+                ty += (int)((r >> 16) % 5) - 2;
+                if (ty < 2) ty = 2; if (ty > H-3) ty = H-3;
+            }
+        }
+    }
+}
+
+// vetas de mineral según profundidad
+inline void pass_ores(std::uint32_t seed, GenColumn &col) {
+    const int H = col.H;
+    for (int y = 2; y < H-2; ++y) {
+        for (int x = col.x0; x < col.x0 + CHUNK_SIZE; ++x) {
+            if (col.get(x, y) != (BlockId)STONE) continue;
+            int r = (int)(gen_rand(seed, PASS_ORES, x, y) % 1000);
+            if (r < 40 && y < H/2) col.set(x, y, COAL); // ~4%
+            else if (r < 52 && y >= H/4 && y < (3*H)/4) col.set(x, y, IRON); // ~1.2%
+            else if (r < 55 && y > (3*H)/4) col.set(x, y, GOLD); // ~0.3%
+        }
+    }
+}
+
+// Genera la columna de chunks cx; out recibe un puntero por cy (nullptr si el chunk es todo aire)
+inline void generate_column(std::uint32_t seed, int H, int cx, std::vector<std::unique_ptr<Chunk>> &out, GenStats *stats = nullptr) {
+    typedef void (*PassFn)(std::uint32_t, GenColumn &);
+    static const PassFn passes[PASS_COUNT] = { pass_heightmap, pass_surface, pass_nether, pass_trees, pass_caves, pass_ores };
+
+    GenColumn col(cx, H);
+    for (int i = 0; i < PASS_COUNT; ++i) {
+        auto t0 = std::chrono::steady_clock::now();
+        passes[i](seed, col);
+        if (stats) stats->passNs[i] += (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    }
+    if (stats) ++stats->columns;
+
+    // trocear en chunks, sin reservar los que son todo aire
+    int chunksY = (H + CHUNK_MASK) >> CHUNK_SHIFT;
+    out.clear();
+    out.resize(chunksY);
+    for (int cy = 0; cy < chunksY; ++cy) {
+        std::unique_ptr<Chunk> c;
+        for (int ly = 0; ly < CHUNK_SIZE; ++ly) {
+            int y = cy * CHUNK_SIZE + ly;
+            if (y >= H) break;
+            for (int lx = 0; lx < CHUNK_SIZE; ++lx) {
+                BlockId b = col.cells[(std::size_t)y * CHUNK_SIZE + lx];
+                if (b == (BlockId)AIR) continue;
+                if (!c) {
+                    c.reset(new Chunk(cx, cy, (BlockId)AIR));
+                    c->dirty = CHUNK_DIRTY_ALL & ~CHUNK_DIRTY_SAVE; // recién generado: se puede regenerar, no hace falta guardarlo
+                }
+                c->blocks[(ly << CHUNK_SHIFT) | lx] = b;
+            }
+        }
+        out[cy] = std::move(c);
+    }
+}
+
+inline int gen_thread_count() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? (int)n : 1;
+}
+
+// Genera las columnas [firstCx, firstCx+count) repartidas entre 'threads' hilos.
+// sink(cx, chunks) se llama desde los hilos de trabajo: debe ser seguro en concurrencia.
+template <class Sink>
+void generate_columns_parallel(std::uint32_t seed, int H, int firstCx, int count, int threads, GenStats &stats, Sink sink) {
+    std::atomic<int> next(0);
+    auto work = [&]{
+        std::vector<std::unique_ptr<Chunk>> chunks;
+        for (int i = next++; i < count; i = next++) {
+            generate_column(seed, H, firstCx + i, chunks, &stats);
+            sink(firstCx + i, chunks);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (auto &t : pool) t.join();
+}
+
+// Informe de tiempos de generación: total de columnas y milisegundos por pasada (tiempo de CPU sumado entre hilos)
+inline void print_gen_report(std::ostream &os, const GenStats &stats, double wallMs, int threads) {
+    std::uint64_t cols = stats.columns.load();
+    double cpuMs = 0.0;
+    for (auto &p : stats.passNs) cpuMs += p.load() / 1e6;
+    os << "Generacion: " << cols << " columnas, " << threads << " hilos";
+    if (wallMs > 0.0) os << ", " << std::fixed << std::setprecision(1) << wallMs << " ms reales";
+    os << ", " << std::fixed << std::setprecision(1) << cpuMs << " ms CPU\n";
+    for (int i = 0; i < PASS_COUNT; ++i) {
+        double ms = stats.passNs[i].load() / 1e6;
+        os << "  " << std::left << std::setw(10) << GEN_PASS_NAMES[i] << std::right << std::setw(9) << std::setprecision(2) << ms << " ms";
+        if (cols) os << "  (" << std::setprecision(3) << ms / cols << " ms/columna)";
+        os << "\n";
+    }
+}